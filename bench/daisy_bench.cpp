@@ -0,0 +1,480 @@
+// daisy_bench - microbenchmarks for the c_renderqueue push_* hot paths and font/atlas lookups
+// - build: cl /O2 /std:c++17 /EHsc bench\daisy_bench.cpp
+// - run:   daisy_bench.exe [iterations] > bench_output.txt
+// - queue benchmarks run against a null backend, so they need no device at all
+// - font/atlas benchmarks use a WARP device and are skipped if one cannot be created
+// - every result is printed as one JSON object per line:
+//   { "name": ..., "iterations": ..., "ns_per_op": ..., "bytes_per_op": ... }
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../daisy_dx11.h"
+
+namespace
+{
+	// Backend that only records how much data an upload would have sent
+	class c_null_backend : public daisy::c_daisy_backend
+	{
+	public:
+		uint64_t m_bytes { 0 };
+
+		virtual bool upload( const daisy::renderbuffer_t& vtxs, const daisy::renderbuffer_t& idxs, const daisy::renderbuffer_t& rects, const daisy::renderbuffer_t& glyphs ) noexcept override
+		{
+			this->m_bytes = sizeof( daisy::daisy_vtx_t ) * vtxs.m_size + sizeof( daisy::daisy_idx_t ) * idxs.m_size +
+				sizeof( daisy::daisy_rect_t ) * rects.m_size + sizeof( daisy::daisy_glyph_instance_t ) * glyphs.m_size;
+			return true;
+		}
+
+		virtual void scissor( const daisy::point_t&, const daisy::point_t& ) noexcept override
+		{
+		}
+
+		virtual void draw_indexed( ID3D11ShaderResourceView*, uint32_t, uint32_t, uint32_t ) noexcept override
+		{
+		}
+
+		virtual void draw_rects( ID3D11ShaderResourceView*, uint32_t, uint32_t ) noexcept override
+		{
+		}
+
+		virtual void draw_glyphs( const daisy::c_fontwrapper&, uint32_t, uint32_t ) noexcept override
+		{
+		}
+
+		virtual void draw_shapes( uint32_t, uint32_t ) noexcept override
+		{
+		}
+	};
+
+	struct bench_result_t
+	{
+		double m_ns_per_op;
+		double m_bytes_per_op;
+	};
+
+	void report( const char* name, uint64_t iterations, const bench_result_t& result ) noexcept
+	{
+		printf( "{ \"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"bytes_per_op\": %.1f }\n",
+			name, static_cast< unsigned long long >( iterations ), result.m_ns_per_op, result.m_bytes_per_op );
+	}
+
+	// Times `ops_per_frame` primitives per frame for `frames` frames; the queue is cleared and
+	// flushed around every frame so bytes_per_op is what update( ) would upload per primitive
+	bench_result_t run_queue( daisy::c_renderqueue& queue, c_null_backend& backend, uint64_t frames, uint32_t ops_per_frame,
+		const std::function<void( daisy::c_renderqueue&, uint32_t )>& op ) noexcept
+	{
+		uint64_t bytes = 0;
+
+		const auto start = std::chrono::steady_clock::now( );
+
+		for ( uint64_t f = 0; f < frames; ++f )
+		{
+			queue.clear( );
+
+			for ( uint32_t i = 0; i < ops_per_frame; ++i )
+				op( queue, i );
+
+			backend.m_bytes = 0;
+			queue.flush( );
+			bytes += backend.m_bytes;
+		}
+
+		const auto elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now( ) - start ).count( );
+		const double ops = static_cast< double >( frames ) * ops_per_frame;
+
+		return { elapsed / ops, static_cast< double >( bytes ) / ops };
+	}
+
+	template <typename t>
+	bench_result_t run_plain( uint64_t iterations, const t& op ) noexcept
+	{
+		const auto start = std::chrono::steady_clock::now( );
+
+		for ( uint64_t i = 0; i < iterations; ++i )
+			op( i );
+
+		const auto elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now( ) - start ).count( );
+
+		return { elapsed / static_cast< double >( iterations ), 0.0 };
+	}
+
+	// Font cache folder for fontwrapper_create_cached, under %TEMP% so running from a checkout leaves it clean
+	std::string bench_cache_directory( ) noexcept
+	{
+		char temp[ MAX_PATH ] = { };
+		if ( !GetTempPathA( MAX_PATH, temp ) )
+			return { };
+
+		return std::string( temp ) + "daisy_bench_cache\\";
+	}
+
+	void remove_bench_cache( const std::string& directory ) noexcept
+	{
+		if ( directory.empty( ) )
+			return;
+
+		WIN32_FIND_DATAA found;
+		HANDLE search = FindFirstFileA( ( directory + "daisy_*.font*" ).c_str( ), &found );
+
+		if ( search != INVALID_HANDLE_VALUE )
+		{
+			do
+				DeleteFileA( ( directory + found.cFileName ).c_str( ) );
+			while ( FindNextFileA( search, &found ) );
+
+			FindClose( search );
+		}
+
+		RemoveDirectoryA( directory.c_str( ) );
+	}
+
+	bool create_warp_device( ) noexcept
+	{
+		ID3D11Device* device = nullptr;
+		ID3D11DeviceContext* context = nullptr;
+
+		if ( FAILED( D3D11CreateDevice( nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, &context ) ) )
+			return false;
+
+		// daisy_initialize takes its own references
+		const bool ok = daisy::daisy_initialize( device, context, 1920.f, 1080.f );
+
+		context->Release( );
+		device->Release( );
+
+		return ok;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	const uint64_t frames = argc > 1 ? strtoull( argv[ 1 ], nullptr, 10 ) : 200;
+	constexpr uint32_t ops_per_frame = 2048;
+
+	daisy::daisy_set_viewport( 1920.f, 1080.f );
+
+	c_null_backend backend;
+	daisy::c_renderqueue queue;
+	queue.set_backend( &backend );
+
+	if ( !queue.create( ) )
+		return 1;
+
+	const daisy::color_t white( 255, 255, 255, 255 ), black( 0, 0, 0, 255 );
+
+	report( "push_filled_rectangle", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_filled_rectangle( { static_cast< float >( i % 1900 ), static_cast< float >( i % 1060 ) }, { 16.f, 16.f }, white );
+		} ) );
+
+	report( "push_gradient_rectangle", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_gradient_rectangle( { static_cast< float >( i % 1900 ), static_cast< float >( i % 1060 ) }, { 16.f, 16.f }, white, black, black, white );
+		} ) );
+
+	queue.set_instanced_rects( true );
+
+	report( "push_filled_rectangle_instanced", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_filled_rectangle( { static_cast< float >( i % 1900 ), static_cast< float >( i % 1060 ) }, { 16.f, 16.f }, white );
+		} ) );
+
+	queue.set_instanced_rects( false );
+	queue.set_retained( true );
+
+	// identical overlay every frame, retained mode hashes it and skips the upload
+	report( "push_filled_rectangle_retained", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_filled_rectangle( { static_cast< float >( i % 1900 ), static_cast< float >( i % 1060 ) }, { 16.f, 16.f }, white );
+		} ) );
+
+	queue.set_retained( false );
+
+	report( "push_filled_triangle", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			const float x = static_cast< float >( i % 1900 );
+			q.push_filled_triangle( { x, 0.f }, { x + 10.f, 20.f }, { x - 10.f, 20.f }, white, white, white );
+		} ) );
+
+	report( "push_line", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			const float x = static_cast< float >( i % 1900 );
+			q.push_line( { x, 0.f }, { x + 15.f, 300.f }, white, 2.f );
+		} ) );
+
+	report( "push_filled_circle_32", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_filled_circle( { static_cast< float >( i % 1900 ), 500.f }, 12.f, 32, white, black );
+		} ) );
+
+	report( "push_filled_circle_adaptive", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_filled_circle( { static_cast< float >( i % 1900 ), 500.f }, 4.f + ( i % 5 ) * 8.f, white, black );
+		} ) );
+
+	report( "push_rounded_rectangle", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			q.push_shape( { static_cast< float >( i % 1900 ), 100.f }, { 120.f, 40.f }, 8.f, white, black, 1.f );
+		} ) );
+
+	// one op is one 32 point graph line, as segments and as a stroked polyline
+	daisy::point_t graph[ 32 ];
+	for ( uint32_t i = 0; i < 32; ++i )
+		graph[ i ] = { 20.f + i * 12.f, 300.f + ( ( i * 7919u ) % 97u ) };
+
+	report( "push_line_graph_32", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t )
+		{
+			for ( uint32_t i = 0; i + 1 < 32; ++i )
+				q.push_line( graph[ i ], graph[ i + 1 ], white, 2.f );
+		} ) );
+
+	report( "push_polyline_graph_32", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t )
+		{
+			q.push_polyline( graph, 32, white, 2.f );
+		} ) );
+
+	report( "push_arc", frames * ops_per_frame, run_queue( queue, backend, frames, ops_per_frame, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+		{
+			const float from = ( i % 16 ) * 0.4f;
+			q.push_arc( { static_cast< float >( i % 1900 ), 500.f }, 40.f, from, from + 2.f, white, 2.f );
+		} ) );
+
+	// starts every frame from a tiny queue so the growth path in ensure_buffers_capacity is part of the cost
+	{
+		const uint64_t growth_frames = frames / 4 + 1;
+
+		const auto result = run_plain( growth_frames, [ & ]( uint64_t )
+			{
+				c_null_backend growth_backend;
+				daisy::c_renderqueue growth_queue;
+				growth_queue.set_backend( &growth_backend );
+
+				if ( !growth_queue.create( 64, 96 ) )
+					return;
+
+				for ( uint32_t i = 0; i < ops_per_frame; ++i )
+					growth_queue.push_filled_rectangle( { 0.f, 0.f }, { 4.f, 4.f }, white );
+			} );
+
+		report( "ensure_buffers_capacity_growth", growth_frames * ops_per_frame, { result.m_ns_per_op / ops_per_frame, 0.0 } );
+	}
+
+	// 4 threads record ops_per_frame rectangles each into a c_parallel_queue, flush( ) merges and uploads them
+	{
+		constexpr uint32_t threads = 4;
+
+		daisy::c_parallel_queue parallel;
+		parallel.queue( )->set_backend( &backend );
+
+		if ( parallel.create( threads ) )
+		{
+			uint64_t bytes = 0;
+
+			const auto start = std::chrono::steady_clock::now( );
+
+			for ( uint64_t f = 0; f < frames; ++f )
+			{
+				parallel.clear( );
+
+				std::vector<std::thread> workers;
+				for ( uint32_t t = 0; t < threads; ++t )
+				{
+					workers.emplace_back( [ &, t ]( )
+						{
+							auto q = parallel.sub_queue( t );
+							for ( uint32_t i = 0; i < ops_per_frame; ++i )
+								q->push_filled_rectangle( { static_cast< float >( i % 1900 ), static_cast< float >( t * 16 ) }, { 16.f, 16.f }, white );
+						} );
+				}
+
+				for ( auto& worker : workers )
+					worker.join( );
+
+				backend.m_bytes = 0;
+				parallel.flush( );
+				bytes += backend.m_bytes;
+			}
+
+			const auto elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now( ) - start ).count( );
+			const double ops = static_cast< double >( frames ) * ops_per_frame * threads;
+
+			report( "parallel_queue_4_threads", frames * ops_per_frame * threads, { elapsed / ops, static_cast< double >( bytes ) / ops } );
+		}
+	}
+
+	if ( !create_warp_device( ) )
+	{
+		printf( "{ \"name\": \"font_and_atlas\", \"skipped\": \"no d3d11 device\" }\n" );
+		return 0;
+	}
+
+	daisy::c_fontwrapper font;
+	if ( font.create( "Segoe UI", 16, ANTIALIASED_QUALITY, daisy::FONT_DEFAULT ) )
+	{
+		static constexpr std::string_view label = "Health: 100 / 100  Armor: 75  Ammo: 30 / 120";
+
+		// one op is a whole 44 character label
+		report( "push_text_label", frames * ( ops_per_frame / 16 ), run_queue( queue, backend, frames, ops_per_frame / 16, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+			{
+				q.push_text( font, { 10.f, static_cast< float >( i % 1060 ) }, label, white );
+			} ) );
+
+		queue.set_instanced_glyphs( true );
+
+		report( "push_text_label_instanced", frames * ( ops_per_frame / 16 ), run_queue( queue, backend, frames, ops_per_frame / 16, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+			{
+				q.push_text( font, { 10.f, static_cast< float >( i % 1060 ) }, label, white );
+			} ) );
+
+		queue.set_instanced_glyphs( false );
+		queue.set_text_cache( 64 );
+
+		report( "push_text_label_cached", frames * ( ops_per_frame / 16 ), run_queue( queue, backend, frames, ops_per_frame / 16, [ & ]( daisy::c_renderqueue& q, uint32_t i )
+			{
+				q.push_text( font, { 10.f, static_cast< float >( i % 1060 ) }, label, white );
+			} ) );
+
+		queue.set_text_cache( 0 );
+
+		volatile float sink = 0.f;
+
+		const uint64_t lookups = frames * ops_per_frame * 16;
+		report( "fontwrapper_coords", lookups, run_plain( lookups, [ & ]( uint64_t i )
+			{
+				sink = sink + font.coords( static_cast< char >( 32 + i % 95 ) )[ 0 ];
+			} ) );
+
+		const uint64_t extents = frames * ops_per_frame;
+		report( "fontwrapper_text_extent", extents, run_plain( extents, [ & ]( uint64_t )
+			{
+				sink = sink + font.text_extent( label ).x;
+			} ) );
+
+		// same label with a few multibyte characters, decoded straight from UTF-8
+		static constexpr std::string_view label_utf8 = "Health: 100 / 100  R\xC3\xBCstung: 75  \xD0\x9F\xD0\xB0\xD1\x82\xD1\x80\xD0\xBE\xD0\xBD\xD1\x8B: 30";
+
+		report( "fontwrapper_text_extent_utf8", extents, run_plain( extents, [ & ]( uint64_t )
+			{
+				sink = sink + font.text_extent( label_utf8 ).x;
+			} ) );
+
+		// one op is one label of a 64 label batch
+		const std::string_view labels[ 64 ] = { label, label, label, label, label, label, label, label, label, label, label, label, label, label, label, label,
+			label, label, label, label, label, label, label, label, label, label, label, label, label, label, label, label,
+			label, label, label, label, label, label, label, label, label, label, label, label, label, label, label, label,
+			label, label, label, label, label, label, label, label, label, label, label, label, label, label, label, label };
+		daisy::daisy_text_measure_t measured;
+
+		const auto batch = run_plain( extents / 64, [ & ]( uint64_t )
+			{
+				font.measure( labels, 64, measured );
+				sink = sink + measured.m_extents[ 63 ].x;
+			} );
+
+		report( "fontwrapper_measure_batch", extents, { batch.m_ns_per_op / 64, 0.0 } );
+
+		font.set_measure_cache( 256 );
+
+		report( "fontwrapper_text_extent_memo", extents, run_plain( extents, [ & ]( uint64_t )
+			{
+				sink = sink + font.text_extent( label ).x;
+			} ) );
+
+		font.set_measure_cache( 0 );
+	}
+
+	// one op is a whole font creation: baking every glyph of the font, loading that atlas from the font cache
+	// (filled by a create before timing) and rasterizing printable ASCII only
+	struct create_variant_t
+	{
+		const char* m_name;
+		uint8_t m_flags;
+		std::string_view m_cache;
+	};
+
+	const std::string cache_directory = bench_cache_directory( );
+
+	for ( const auto& variant : { create_variant_t { "fontwrapper_create", daisy::FONT_DEFAULT, "" },
+			  create_variant_t { "fontwrapper_create_cached", daisy::FONT_DEFAULT, cache_directory },
+			  create_variant_t { "fontwrapper_create_lazy", daisy::FONT_LAZY, "" },
+			  create_variant_t { "fontwrapper_create_sdf", daisy::FONT_SDF, "" } } )
+	{
+		daisy::daisy_set_font_cache( variant.m_cache );
+
+		const auto create = [ & ]( uint64_t )
+		{
+			daisy::c_fontwrapper created;
+			if ( !created.create( "Segoe UI", 16, ANTIALIASED_QUALITY, variant.m_flags ) )
+				printf( "{ \"name\": \"%s\", \"error\": \"create failed\" }\n", variant.m_name );
+		};
+
+		if ( !variant.m_cache.empty( ) )
+			create( 0 );
+
+		report( variant.m_name, 4, run_plain( 4, create ) );
+	}
+
+	daisy::daisy_set_font_cache( "" );
+	remove_bench_cache( cache_directory );
+
+	daisy::c_texatlas atlas;
+	if ( atlas.create( { 2048.f, 2048.f } ) )
+	{
+		static uint8_t icon[ 32 * 32 * 4 ] = { };
+
+		// 4096 32x32 icons fill a 2048x2048 atlas exactly
+		const uint64_t appends = 4096;
+		report( "texatlas_append_32x32", appends, run_plain( appends, [ & ]( uint64_t i )
+			{
+				atlas.append( static_cast< uint32_t >( i ), { 32.f, 32.f }, icon, sizeof( icon ) );
+			} ) );
+	}
+
+	daisy::c_texatlas batch_atlas;
+	if ( batch_atlas.create( { 2048.f, 2048.f } ) )
+	{
+		static uint8_t icon[ 32 * 32 * 4 ] = { };
+
+		std::vector<daisy::daisy_atlas_image_t> icons( 4096 );
+		for ( uint32_t i = 0; i < icons.size( ); i++ )
+			icons[ i ] = { i, { 32.f, 32.f }, icon, sizeof( icon ) };
+
+		// the same 4096 icons in one batch, reported per icon
+		const auto batch = run_plain( 1, [ & ]( uint64_t )
+			{
+				batch_atlas.append_batch( icons.data( ), icons.size( ) );
+			} );
+		report( "texatlas_append_batch_32x32", icons.size( ), { batch.m_ns_per_op / icons.size( ), 0.0 } );
+	}
+
+	daisy::c_imagecache images;
+	if ( images.create( { 1024.f, 1024.f }, 2 ) )
+	{
+		static uint8_t icon[ 48 * 48 * 4 ] = { };
+
+		// 64 lookups a frame over 4096 uuids of mixed sizes, twice what fits, so misses evict and reuse rectangles
+		const uint64_t lookups = 64 * 256;
+		report( "imagecache_churn", lookups, run_plain( lookups, [ & ]( uint64_t i )
+			{
+				if ( i % 64 == 0 )
+					images.next_frame( );
+
+				const uint32_t uuid = static_cast< uint32_t >( ( i * 2654435761u ) % 4096 );
+				const float side = 16.f + ( uuid % 3 ) * 16.f;
+
+				daisy::daisy_image_t image;
+				if ( !images.find( uuid, image ) )
+					images.insert( uuid, { side, side }, icon, sizeof( icon ) );
+			} ) );
+	}
+
+	daisy::daisy_shutdown( );
+
+	return 0;
+}
@@ -14,17 +14,220 @@
 #include <string>
 #include <string_view>
 #include <atomic>
+#include <mutex>
 #include <memory>
+#include <algorithm>
 #include <cstdint>
 namespace stl = std;
 #endif
 
+// SSE2 checks 16 bytes of UTF-8 text at a time for ASCII, see daisy_code_points_t
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#define DAISY_HAS_SSE2
+#endif
+
+#ifndef DAISY_NO_D3D11
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3dcompiler.lib")
+#else
+// DAISY_NO_D3D11: stand-ins for the Windows, GDI and D3D11 declarations daisy uses, so c_renderqueue and c_cpu_backend
+// build without the Windows SDK (headless test agents). Leave daisy_t::s_device null and give queues a backend:
+// every device call and every GDI/file call fails, so fonts and GPU resources can't be created
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+
+typedef int32_t HRESULT, LONG, BOOL;
+typedef uint32_t UINT, ULONG, DWORD;
+typedef uint16_t WORD;
+typedef uint8_t BYTE;
+typedef wchar_t WCHAR;
+typedef size_t SIZE_T;
+typedef void* HANDLE;
+typedef void* HDC;
+typedef void* HGDIOBJ;
+typedef void* HBITMAP;
+typedef void* HFONT;
+
+#define TRUE 1
+#define FALSE 0
+#define E_FAIL ( static_cast< HRESULT >( 0x80004005 ) )
+#define FAILED( hr ) ( static_cast< HRESULT >( hr ) < 0 )
+#define SUCCEEDED( hr ) ( static_cast< HRESULT >( hr ) >= 0 )
+#ifndef min
+#define min( a, b ) ( ( ( a ) < ( b ) ) ? ( a ) : ( b ) )
+#endif
+#ifndef max
+#define max( a, b ) ( ( ( a ) > ( b ) ) ? ( a ) : ( b ) )
+#endif
+#define RGB( r, g, b ) ( static_cast< DWORD >( ( r ) | ( ( g ) << 8 ) | ( ( b ) << 16 ) ) )
+#define INVALID_HANDLE_VALUE ( reinterpret_cast< HANDLE >( static_cast< intptr_t >( -1 ) ) )
+#define LF_FACESIZE 32
+
+enum : uint32_t
+{
+	BI_RGB = 0, DIB_RGB_COLORS = 0, MM_TEXT = 1, OPAQUE = 2, TA_TOP = 0, ETO_OPAQUE = 2, FW_NORMAL = 400, FW_BOLD = 700,
+	DEFAULT_CHARSET = 1, OUT_DEFAULT_PRECIS = 0, CLIP_DEFAULT_PRECIS = 0, VARIABLE_PITCH = 2, NONANTIALIASED_QUALITY = 3,
+	ANTIALIASED_QUALITY = 4, CLEARTYPE_QUALITY = 5, GENERIC_READ = 0x80000000, GENERIC_WRITE = 0x40000000, FILE_SHARE_READ = 1,
+	CREATE_ALWAYS = 2, OPEN_EXISTING = 3, FILE_ATTRIBUTE_NORMAL = 0x80, PAGE_READONLY = 2, FILE_MAP_READ = 4,
+	MOVEFILE_REPLACE_EXISTING = 1
+};
+
+struct SIZE { LONG cx, cy; };
+struct RECT { LONG left, top, right, bottom; };
+struct LARGE_INTEGER { int64_t QuadPart; };
+struct WCRANGE { WCHAR wcLow; uint16_t cGlyphs; };
+struct GLYPHSET { DWORD cbThis, flAccel, cGlyphsSupported, cRanges; WCRANGE ranges[ 1 ]; };
+struct BITMAPINFOHEADER { DWORD biSize; LONG biWidth, biHeight; WORD biPlanes, biBitCount; DWORD biCompression, biSizeImage; LONG biXPelsPerMeter, biYPelsPerMeter; DWORD biClrUsed, biClrImportant; };
+struct BITMAPINFO { BITMAPINFOHEADER bmiHeader; DWORD bmiColors[ 1 ]; };
+
+inline void OutputDebugStringA( const char* ) { }
+inline HDC CreateCompatibleDC( HDC ) { return nullptr; }
+inline BOOL DeleteDC( HDC ) { return FALSE; }
+inline BOOL DeleteObject( HGDIOBJ ) { return FALSE; }
+inline HGDIOBJ SelectObject( HDC, HGDIOBJ ) { return nullptr; }
+inline int SetMapMode( HDC, int ) { return 0; }
+inline DWORD SetTextColor( HDC, DWORD ) { return 0; }
+inline DWORD SetBkColor( HDC, DWORD ) { return 0; }
+inline int SetBkMode( HDC, int ) { return 0; }
+inline UINT SetTextAlign( HDC, UINT ) { return 0; }
+inline BOOL GdiFlush( ) { return FALSE; }
+inline HFONT CreateFontA( int, int, int, int, int, DWORD, DWORD, DWORD, DWORD, DWORD, DWORD, DWORD, DWORD, const char* ) { return nullptr; }
+inline HBITMAP CreateDIBSection( HDC, const BITMAPINFO*, UINT, void** bits, HANDLE, DWORD ) { *bits = nullptr; return nullptr; }
+inline BOOL GetTextExtentPoint32W( HDC, const wchar_t*, int, SIZE* ) { return FALSE; }
+inline BOOL ExtTextOutW( HDC, int, int, UINT, const RECT*, const wchar_t*, UINT, const int* ) { return FALSE; }
+inline DWORD GetFontUnicodeRanges( HDC, GLYPHSET* ) { return 0; }
+inline DWORD GetFontData( HDC, DWORD, DWORD, void*, DWORD ) { return ~0u; }
+inline int GetTextFaceA( HDC, int, char* ) { return 0; }
+inline HANDLE CreateFileA( const char*, DWORD, DWORD, void*, DWORD, DWORD, HANDLE ) { return INVALID_HANDLE_VALUE; }
+inline HANDLE CreateFileMappingA( HANDLE, void*, DWORD, DWORD, DWORD, const char* ) { return nullptr; }
+inline void* MapViewOfFile( HANDLE, DWORD, DWORD, DWORD, SIZE_T ) { return nullptr; }
+inline BOOL UnmapViewOfFile( const void* ) { return FALSE; }
+inline BOOL GetFileSizeEx( HANDLE, LARGE_INTEGER* ) { return FALSE; }
+inline BOOL WriteFile( HANDLE, const void*, DWORD, DWORD*, void* ) { return FALSE; }
+inline BOOL CloseHandle( HANDLE ) { return FALSE; }
+inline BOOL MoveFileExA( const char*, const char*, DWORD ) { return FALSE; }
+inline BOOL DeleteFileA( const char* ) { return FALSE; }
+inline BOOL CreateDirectoryA( const char*, void* ) { return FALSE; }
+
+enum DXGI_FORMAT { DXGI_FORMAT_UNKNOWN = 0, DXGI_FORMAT_R32G32B32A32_FLOAT = 2, DXGI_FORMAT_R32G32B32_FLOAT = 6, DXGI_FORMAT_R16G16B16A16_UNORM = 11,
+	DXGI_FORMAT_R32G32_FLOAT = 16, DXGI_FORMAT_R8G8B8A8_UNORM = 28, DXGI_FORMAT_R16G16_UNORM = 35, DXGI_FORMAT_R32_UINT = 42,
+	DXGI_FORMAT_R16_UINT = 57, DXGI_FORMAT_A8_UNORM = 65, DXGI_FORMAT_B8G8R8A8_UNORM = 87 };
+enum D3D11_USAGE { D3D11_USAGE_DEFAULT, D3D11_USAGE_IMMUTABLE, D3D11_USAGE_DYNAMIC, D3D11_USAGE_STAGING };
+enum D3D11_MAP { D3D11_MAP_READ = 1, D3D11_MAP_WRITE = 2, D3D11_MAP_WRITE_DISCARD = 4, D3D11_MAP_WRITE_NO_OVERWRITE = 5 };
+enum D3D11_SRV_DIMENSION { D3D11_SRV_DIMENSION_BUFFER = 1, D3D11_SRV_DIMENSION_TEXTURE2D = 4, D3D11_SRV_DIMENSION_TEXTURE2DARRAY = 5 };
+enum D3D11_INPUT_CLASSIFICATION { D3D11_INPUT_PER_VERTEX_DATA, D3D11_INPUT_PER_INSTANCE_DATA };
+enum D3D11_PRIMITIVE_TOPOLOGY { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP = 5 };
+enum D3D11_BLEND { D3D11_BLEND_ZERO = 1, D3D11_BLEND_ONE = 2, D3D11_BLEND_SRC_ALPHA = 5, D3D11_BLEND_INV_SRC_ALPHA = 6 };
+enum D3D11_BLEND_OP { D3D11_BLEND_OP_ADD = 1 };
+enum D3D11_FILL_MODE { D3D11_FILL_SOLID = 3 };
+enum D3D11_CULL_MODE { D3D11_CULL_NONE = 1 };
+enum D3D11_DEPTH_WRITE_MASK { D3D11_DEPTH_WRITE_MASK_ZERO };
+enum D3D11_COMPARISON_FUNC { D3D11_COMPARISON_NEVER = 1, D3D11_COMPARISON_ALWAYS = 8 };
+enum D3D11_FILTER { D3D11_FILTER_MIN_MAG_MIP_POINT = 0, D3D11_FILTER_MIN_MAG_MIP_LINEAR = 0x15 };
+enum D3D11_TEXTURE_ADDRESS_MODE { D3D11_TEXTURE_ADDRESS_CLAMP = 3 };
+enum : uint32_t
+{
+	D3D11_BIND_VERTEX_BUFFER = 1, D3D11_BIND_INDEX_BUFFER = 2, D3D11_BIND_CONSTANT_BUFFER = 4, D3D11_BIND_SHADER_RESOURCE = 8,
+	D3D11_CPU_ACCESS_WRITE = 0x10000, D3D11_CPU_ACCESS_READ = 0x20000, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED = 0x40,
+	D3D11_COLOR_WRITE_ENABLE_ALL = 15, D3D11_APPEND_ALIGNED_ELEMENT = 0xFFFFFFFF, D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION = 2048,
+	D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION = 16384, D3DCOMPILE_ENABLE_STRICTNESS = 2
+};
+#define D3D11_FLOAT32_MAX ( 3.402823466e+38f )
+
+struct DXGI_SAMPLE_DESC { UINT Count, Quality; };
+struct D3D11_TEXTURE2D_DESC { UINT Width, Height, MipLevels, ArraySize; DXGI_FORMAT Format; DXGI_SAMPLE_DESC SampleDesc; D3D11_USAGE Usage; UINT BindFlags, CPUAccessFlags, MiscFlags; };
+struct D3D11_BUFFER_DESC { UINT ByteWidth; D3D11_USAGE Usage; UINT BindFlags, CPUAccessFlags, MiscFlags, StructureByteStride; };
+struct D3D11_BUFFER_SRV { UINT FirstElement, NumElements; };
+struct D3D11_TEX2D_SRV { UINT MostDetailedMip, MipLevels; };
+struct D3D11_TEX2D_ARRAY_SRV { UINT MostDetailedMip, MipLevels, FirstArraySlice, ArraySize; };
+struct D3D11_SHADER_RESOURCE_VIEW_DESC { DXGI_FORMAT Format; D3D11_SRV_DIMENSION ViewDimension; union { D3D11_BUFFER_SRV Buffer; D3D11_TEX2D_SRV Texture2D; D3D11_TEX2D_ARRAY_SRV Texture2DArray; }; };
+struct D3D11_SUBRESOURCE_DATA { const void* pSysMem; UINT SysMemPitch, SysMemSlicePitch; };
+struct D3D11_MAPPED_SUBRESOURCE { void* pData; UINT RowPitch, DepthPitch; };
+struct D3D11_INPUT_ELEMENT_DESC { const char* SemanticName; UINT SemanticIndex; DXGI_FORMAT Format; UINT InputSlot, AlignedByteOffset; D3D11_INPUT_CLASSIFICATION InputSlotClass; UINT InstanceDataStepRate; };
+struct D3D11_RENDER_TARGET_BLEND_DESC { BOOL BlendEnable; D3D11_BLEND SrcBlend, DestBlend; D3D11_BLEND_OP BlendOp; D3D11_BLEND SrcBlendAlpha, DestBlendAlpha; D3D11_BLEND_OP BlendOpAlpha; UINT RenderTargetWriteMask; };
+struct D3D11_BLEND_DESC { BOOL AlphaToCoverageEnable, IndependentBlendEnable; D3D11_RENDER_TARGET_BLEND_DESC RenderTarget[ 8 ]; };
+struct D3D11_RASTERIZER_DESC { D3D11_FILL_MODE FillMode; D3D11_CULL_MODE CullMode; BOOL FrontCounterClockwise; int DepthBias; float DepthBiasClamp, SlopeScaledDepthBias; BOOL DepthClipEnable, ScissorEnable, MultisampleEnable, AntialiasedLineEnable; };
+struct D3D11_DEPTH_STENCIL_DESC { BOOL DepthEnable; D3D11_DEPTH_WRITE_MASK DepthWriteMask; D3D11_COMPARISON_FUNC DepthFunc; BOOL StencilEnable; };
+struct D3D11_SAMPLER_DESC { D3D11_FILTER Filter; D3D11_TEXTURE_ADDRESS_MODE AddressU, AddressV, AddressW; float MipLODBias; UINT MaxAnisotropy; D3D11_COMPARISON_FUNC ComparisonFunc; float BorderColor[ 4 ]; float MinLOD, MaxLOD; };
+struct D3D11_BOX { UINT left, top, front, right, bottom, back; };
+typedef RECT D3D11_RECT;
+
+struct IUnknown
+{
+	ULONG AddRef( ) { return 1; }
+	ULONG Release( ) { return 0; }
+};
+struct ID3D11Resource : IUnknown { };
+struct ID3D11Buffer : ID3D11Resource { };
+struct ID3D11Texture2D : ID3D11Resource { };
+struct ID3D11ShaderResourceView : IUnknown { };
+struct ID3D11VertexShader : IUnknown { };
+struct ID3D11PixelShader : IUnknown { };
+struct ID3D11InputLayout : IUnknown { };
+struct ID3D11BlendState : IUnknown { };
+struct ID3D11RasterizerState : IUnknown { };
+struct ID3D11DepthStencilState : IUnknown { };
+struct ID3D11SamplerState : IUnknown { };
+struct ID3DBlob : IUnknown
+{
+	void* GetBufferPointer( ) { return nullptr; }
+	SIZE_T GetBufferSize( ) { return 0; }
+};
+
+struct ID3D11Device : IUnknown
+{
+	HRESULT CreateTexture2D( const D3D11_TEXTURE2D_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture2D** ) { return E_FAIL; }
+	HRESULT CreateBuffer( const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer** ) { return E_FAIL; }
+	HRESULT CreateShaderResourceView( ID3D11Resource*, const D3D11_SHADER_RESOURCE_VIEW_DESC*, ID3D11ShaderResourceView** ) { return E_FAIL; }
+	HRESULT CreateVertexShader( const void*, SIZE_T, void*, ID3D11VertexShader** ) { return E_FAIL; }
+	HRESULT CreatePixelShader( const void*, SIZE_T, void*, ID3D11PixelShader** ) { return E_FAIL; }
+	HRESULT CreateInputLayout( const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout** ) { return E_FAIL; }
+	HRESULT CreateBlendState( const D3D11_BLEND_DESC*, ID3D11BlendState** ) { return E_FAIL; }
+	HRESULT CreateRasterizerState( const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState** ) { return E_FAIL; }
+	HRESULT CreateDepthStencilState( const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState** ) { return E_FAIL; }
+	HRESULT CreateSamplerState( const D3D11_SAMPLER_DESC*, ID3D11SamplerState** ) { return E_FAIL; }
+};
+
+struct ID3D11DeviceContext : IUnknown
+{
+	HRESULT Map( ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* ) { return E_FAIL; }
+	void Unmap( ID3D11Resource*, UINT ) { }
+	void UpdateSubresource( ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT ) { }
+	void CopySubresourceRegion( ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX* ) { }
+	void CopyResource( ID3D11Resource*, ID3D11Resource* ) { }
+	void IASetVertexBuffers( UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT* ) { }
+	void IASetIndexBuffer( ID3D11Buffer*, DXGI_FORMAT, UINT ) { }
+	void IASetInputLayout( ID3D11InputLayout* ) { }
+	void IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY ) { }
+	void VSSetShader( ID3D11VertexShader*, void*, UINT ) { }
+	void PSSetShader( ID3D11PixelShader*, void*, UINT ) { }
+	void VSSetConstantBuffers( UINT, UINT, ID3D11Buffer* const* ) { }
+	void PSSetConstantBuffers( UINT, UINT, ID3D11Buffer* const* ) { }
+	void VSSetShaderResources( UINT, UINT, ID3D11ShaderResourceView* const* ) { }
+	void PSSetShaderResources( UINT, UINT, ID3D11ShaderResourceView* const* ) { }
+	void PSSetSamplers( UINT, UINT, ID3D11SamplerState* const* ) { }
+	void OMSetBlendState( ID3D11BlendState*, const float*, UINT ) { }
+	void OMSetDepthStencilState( ID3D11DepthStencilState*, UINT ) { }
+	void RSSetState( ID3D11RasterizerState* ) { }
+	void RSSetScissorRects( UINT, const D3D11_RECT* ) { }
+	void DrawIndexed( UINT, UINT, int ) { }
+	void DrawIndexedInstanced( UINT, UINT, UINT, int, UINT ) { }
+};
+
+inline HRESULT D3DCompile( const void*, SIZE_T, const char*, const void*, void*, const char*, const char*, UINT, UINT, ID3DBlob**, ID3DBlob** error_blob )
+{
+	if ( error_blob )
+		*error_blob = nullptr;
+
+	return E_FAIL;
+}
+#endif
 
 namespace daisy
 {
@@ -137,11 +340,149 @@ namespace daisy
 	};
 
 	// Vertex struct - modified for D3D11
+	// - define DAISY_COMPACT_VERTEX for a 16 byte layout (2x float position, packed color, unorm16 uv)
+	// - stays an aggregate, daisy_make_vtx fills either layout
 	struct daisy_vtx_t
 	{
-		float m_pos[ 4 ]; // x,y,z,w (was rhw in D3D9)
+#ifdef DAISY_COMPACT_VERTEX
+		float m_pos[ 2 ]; // x,y - z/w are filled in by the input assembler
+		uint32_t m_col; // RGBA color
+		uint16_t m_uv[ 2 ]; // unorm16
+
+		float u( ) const noexcept
+		{
+			return this->m_uv[ 0 ] / 65535.f;
+		}
+		float v( ) const noexcept
+		{
+			return this->m_uv[ 1 ] / 65535.f;
+		}
+		float slice( ) const noexcept
+		{
+			return 0.f;
+		}
+#else
+		float m_pos[ 4 ]; // x,y,z,w (was rhw in D3D9) - z is the texture array slice, 0 for plain textures
 		uint32_t m_col; // RGBA color
 		float m_uv[ 2 ];
+
+		float u( ) const noexcept
+		{
+			return this->m_uv[ 0 ];
+		}
+		float v( ) const noexcept
+		{
+			return this->m_uv[ 1 ];
+		}
+		float slice( ) const noexcept
+		{
+			return this->m_pos[ 2 ];
+		}
+#endif
+	};
+
+	constexpr uint16_t daisy_to_unorm16( float f ) noexcept
+	{
+		return static_cast< uint16_t >( ( f < 0.f ? 0.f : ( f > 1.f ? 1.f : f ) ) * 65535.f + 0.5f );
+	}
+
+	// Builds a vertex in whichever layout is compiled in, the compact one has no room for a texture array slice
+	constexpr daisy_vtx_t daisy_make_vtx( float x, float y, uint32_t col, float u, float v, float slice = 0.f ) noexcept
+	{
+#ifdef DAISY_COMPACT_VERTEX
+		( void ) slice;
+		return daisy_vtx_t { { x, y }, col, { daisy_to_unorm16( u ), daisy_to_unorm16( v ) } };
+#else
+		return daisy_vtx_t { { x, y, slice, 1.f }, col, { u, v } };
+#endif
+	}
+
+#ifdef DAISY_COMPACT_VERTEX
+	static_assert( sizeof( daisy_vtx_t ) == 16, "compact vertex layout must match the input layout in daisy_initialize" );
+#else
+	static_assert( sizeof( daisy_vtx_t ) == 28, "vertex layout must match the input layout in daisy_initialize" );
+#endif
+
+	// Index type - define DAISY_32BIT_INDICES to lift the 65536 vertices per drawcall limit
+#ifdef DAISY_32BIT_INDICES
+	using daisy_idx_t = uint32_t;
+	constexpr DXGI_FORMAT daisy_idx_format = DXGI_FORMAT_R32_UINT;
+#else
+	using daisy_idx_t = uint16_t;
+	constexpr DXGI_FORMAT daisy_idx_format = DXGI_FORMAT_R16_UINT;
+#endif
+
+	// Max vertices a single drawcall can address relative to its base vertex
+	constexpr uint64_t daisy_max_batch_vertices = static_cast< uint64_t >( static_cast< daisy_idx_t >( ~0ull ) ) + 1;
+
+	// Texture array slice - where a registered texture lives inside daisy_t::s_texture_array
+	struct daisy_slice_t
+	{
+		float m_slice;
+		float m_uv_scale[ 2 ]; // texture size / slice size
+	};
+
+	// SDF fonts store the distance to the glyph edge, +-daisy_sdf_spread atlas texels mapped onto alpha 0..1
+	// - keep in sync with Spread in shaders::sdf_pixel_shader_src
+	constexpr float daisy_sdf_spread = 6.f;
+	constexpr uint32_t daisy_max_text_styles = 16;
+
+	// Circles, rings, arcs and pies pick their segment count from the radius, rounded up to a multiple of 4 within these
+	constexpr uint32_t daisy_min_circle_segments = 8;
+	constexpr uint32_t daisy_max_circle_segments = 1024;
+	constexpr float daisy_pi = 3.14159265358979323846f;
+
+	// Segments for a circle of radius pixels whose chords stay within tolerance pixels of the true edge
+	inline uint32_t daisy_circle_segments( float radius, float tolerance ) noexcept
+	{
+		if ( !( radius > tolerance ) || !( tolerance > 0.f ) )
+			return daisy_min_circle_segments;
+
+		// a chord spanning theta sits radius * ( 1 - cos( theta / 2 ) ) inside the edge
+		const float segments = ceilf( daisy_pi / acosf( 1.f - tolerance / radius ) );
+		if ( segments >= static_cast< float >( daisy_max_circle_segments ) )
+			return daisy_max_circle_segments;
+
+		const uint32_t rounded = ( static_cast< uint32_t >( segments ) + 3 ) & ~3u;
+		return min( max( rounded, daisy_min_circle_segments ), daisy_max_circle_segments );
+	}
+
+	// Outline and glow drawn around SDF text, see daisy_add_text_style - widths are in atlas texels and together
+	// should stay within daisy_sdf_spread
+	struct daisy_text_style_t
+	{
+		color_t m_outline_color;
+		float m_outline_width;
+		color_t m_glow_color;
+		float m_glow_width;
+	};
+
+	// Rectangle instance - expanded into a quad by shaders::rect_vertex_shader_src
+	// - shapes (CALL_SHAPE) use the same layout: m_col[ 0 ] fill, m_col[ 1 ] border,
+	//   m_uv corner radius, border width and softness in pixels
+	struct daisy_rect_t
+	{
+		float m_rect[ 4 ]; // x,y,w,h
+		uint32_t m_col[ 4 ]; // top left, top right, bottom left, bottom right
+		float m_uv[ 4 ]; // uv mins, uv maxs
+	};
+
+	// Glyph table entry - one per rasterized glyph, uploaded per font as a structured buffer
+	struct daisy_glyph_t
+	{
+		stl::array<float, 4> m_uv; // uv mins, uv maxs
+		float m_size[ 2 ]; // quad size in pixels
+		float m_advance; // pen advance in pixels
+	};
+
+	static_assert( sizeof( daisy_glyph_t ) == 28, "glyph table entry must match struct Glyph in the glyph vertex shader" );
+
+	// Glyph instance - expanded into a quad by shaders::glyph_vertex_shader_src
+	struct daisy_glyph_instance_t
+	{
+		float m_pos[ 2 ];
+		uint32_t m_glyph; // index into the font's glyph table
+		uint32_t m_col;
 	};
 
 	// Buffer structure
@@ -151,12 +492,254 @@ namespace daisy
 		uint32_t m_capacity { 0 }, m_size { 0 };
 	};
 
+	// GPU side of a ring-buffered upload (in elements), see c_renderqueue::set_ring_upload
+	struct ringbuffer_t
+	{
+		uint32_t m_capacity { 0 }, m_cursor { 0 };
+	};
+
+	// Retained mode hashes uploads in blocks of this many bytes to find the dirty span, see c_renderqueue::set_retained
+	constexpr uint32_t daisy_retained_block = 4096;
+
+	// 64-bit hash of a byte range, 4 independent lanes so it runs close to memory speed
+	inline uint64_t daisy_hash( const uint8_t* data, size_t size ) noexcept
+	{
+		constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull, prime2 = 0xC2B2AE3D27D4EB4Full;
+
+		uint64_t lanes[ 4 ] = { prime1, prime2, ~prime1, ~prime2 };
+		uint64_t k[ 4 ];
+		size_t i = 0;
+
+		for ( ; i + 32 <= size; i += 32 )
+		{
+			memcpy( k, data + i, sizeof( k ) );
+
+			lanes[ 0 ] = ( lanes[ 0 ] + k[ 0 ] ) * prime1;
+			lanes[ 1 ] = ( lanes[ 1 ] + k[ 1 ] ) * prime1;
+			lanes[ 2 ] = ( lanes[ 2 ] + k[ 2 ] ) * prime1;
+			lanes[ 3 ] = ( lanes[ 3 ] + k[ 3 ] ) * prime1;
+		}
+
+		memset( k, 0, sizeof( k ) );
+		memcpy( k, data + i, size - i );
+
+		uint64_t h = size * prime2;
+		for ( size_t lane = 0; lane < 4; lane++ )
+		{
+			h = ( h ^ ( lanes[ lane ] >> 29 ) ^ lanes[ lane ] ^ k[ lane ] ) * prime2;
+			h ^= h >> 32;
+		}
+
+		return h;
+	}
+
+	// Walks text as code points: 8-bit code units are decoded as UTF-8, wider ones are taken one at a time
+	// - runs of ASCII are found 16 bytes at a time (8 without SSE2) and passed through undecoded
+	// - malformed UTF-8 gives U+FFFD for each byte that can't start a sequence
+	template <typename c>
+	struct daisy_code_points_t
+	{
+		const c* m_cursor;
+		const c* m_end;
+		size_t m_ascii = 0; // code units known to be ASCII from m_cursor on
+
+		daisy_code_points_t( const c* begin, const c* end ) noexcept
+			: m_cursor( begin ), m_end( end )
+		{
+		}
+
+		// Leading ASCII bytes from m_cursor
+		size_t ascii_run( ) const noexcept
+		{
+			const uint8_t* bytes = reinterpret_cast< const uint8_t* >( this->m_cursor );
+			const size_t size = this->m_end - this->m_cursor;
+			size_t run = 0;
+
+#ifdef DAISY_HAS_SSE2
+			while ( run + 16 <= size && !_mm_movemask_epi8( _mm_loadu_si128( reinterpret_cast< const __m128i* >( bytes + run ) ) ) )
+				run += 16;
+#else
+			for ( uint64_t block; run + 8 <= size; run += 8 )
+			{
+				memcpy( &block, bytes + run, sizeof( block ) );
+				if ( block & 0x8080808080808080ull )
+					break;
+			}
+#endif
+
+			while ( run < size && bytes[ run ] < 0x80 )
+				run++;
+
+			return run;
+		}
+
+		bool next( uint32_t& code ) noexcept
+		{
+			if ( this->m_cursor == this->m_end )
+				return false;
+
+			if constexpr ( sizeof( c ) != 1 )
+			{
+				code = static_cast< uint32_t >( *this->m_cursor++ );
+				return true;
+			}
+			else
+			{
+				if ( !this->m_ascii )
+					this->m_ascii = this->ascii_run( );
+
+				if ( this->m_ascii )
+				{
+					this->m_ascii--;
+					code = static_cast< uint8_t >( *this->m_cursor++ );
+					return true;
+				}
+
+				const uint8_t lead = static_cast< uint8_t >( *this->m_cursor );
+				const size_t left = this->m_end - this->m_cursor;
+
+				size_t length = 0;
+				uint32_t minimum = 0;
+
+				if ( ( lead & 0xE0 ) == 0xC0 )
+					length = 2, code = lead & 0x1F, minimum = 0x80;
+				else if ( ( lead & 0xF0 ) == 0xE0 )
+					length = 3, code = lead & 0x0F, minimum = 0x800;
+				else if ( ( lead & 0xF8 ) == 0xF0 )
+					length = 4, code = lead & 0x07, minimum = 0x10000;
+
+				bool valid = length && length <= left;
+
+				for ( size_t i = 1; valid && i < length; i++ )
+				{
+					const uint8_t trail = static_cast< uint8_t >( this->m_cursor[ i ] );
+					valid = ( trail & 0xC0 ) == 0x80;
+					code = ( code << 6 ) | ( trail & 0x3F );
+				}
+
+				// overlong forms, surrogates and values past U+10FFFF are malformed too
+				if ( !valid || code < minimum || code > 0x10FFFF || ( code >= 0xD800 && code <= 0xDFFF ) )
+				{
+					code = 0xFFFD;
+					length = 1;
+				}
+
+				this->m_cursor += length;
+				return true;
+			}
+		}
+	};
+
+	template <typename t>
+	inline daisy_code_points_t<typename t::value_type> daisy_code_points( const t& text ) noexcept
+	{
+		return { text.data( ), text.data( ) + text.size( ) };
+	}
+
+	// One pass of the exact squared euclidean distance transform (Felzenszwalb & Huttenlocher) over n values
+	// step elements apart, v/z are scratch of n and n + 1 entries
+	inline void daisy_edt_1d( float* f, size_t n, size_t step, float* d, int32_t* v, float* z ) noexcept
+	{
+		constexpr float inf = 1e30f;
+
+		int32_t k = 0;
+		v[ 0 ] = 0;
+		z[ 0 ] = -inf;
+		z[ 1 ] = inf;
+
+		for ( int32_t q = 1; q < static_cast< int32_t >( n ); q++ )
+		{
+			float s;
+
+			while ( true )
+			{
+				const int32_t p = v[ k ];
+				s = ( ( f[ q * step ] + static_cast< float >( q * q ) ) - ( f[ p * step ] + static_cast< float >( p * p ) ) ) / static_cast< float >( 2 * q - 2 * p );
+
+				if ( s > z[ k ] || k == 0 )
+					break;
+
+				k--;
+			}
+
+			k++;
+			v[ k ] = q;
+			z[ k ] = s;
+			z[ k + 1 ] = inf;
+		}
+
+		k = 0;
+		for ( int32_t q = 0; q < static_cast< int32_t >( n ); q++ )
+		{
+			while ( z[ k + 1 ] < static_cast< float >( q ) )
+				k++;
+
+			d[ q ] = static_cast< float >( ( q - v[ k ] ) * ( q - v[ k ] ) ) + f[ v[ k ] * step ];
+		}
+
+		for ( size_t q = 0; q < n; q++ )
+			f[ q * step ] = d[ q ];
+	}
+
+	// Turns 8-bit coverage into a signed distance field in place, see daisy_sdf_spread
+	// - texels are stride bytes apart and rows pitch bytes, partially covered texels keep their coverage as sub-texel offset
+	inline void daisy_distance_field( uint8_t* texels, uint32_t width, uint32_t height, size_t stride, size_t pitch ) noexcept
+	{
+		constexpr float far = 1e20f;
+
+		const size_t count = static_cast< size_t >( width ) * height;
+		const size_t longest = max( width, height );
+
+		stl::vector<float> to_inside( count ), to_outside( count ), d( longest ), z( longest + 1 );
+		stl::vector<int32_t> v( longest );
+
+		for ( uint32_t y = 0; y < height; y++ )
+		{
+			for ( uint32_t x = 0; x < width; x++ )
+			{
+				const bool inside = texels[ y * pitch + x * stride ] > 127;
+				to_inside[ y * width + x ] = inside ? 0.f : far;
+				to_outside[ y * width + x ] = inside ? far : 0.f;
+			}
+		}
+
+		for ( auto* field : { &to_inside, &to_outside } )
+		{
+			for ( uint32_t x = 0; x < width; x++ )
+				daisy_edt_1d( field->data( ) + x, height, width, d.data( ), v.data( ), z.data( ) );
+
+			for ( uint32_t y = 0; y < height; y++ )
+				daisy_edt_1d( field->data( ) + static_cast< size_t >( y ) * width, width, 1, d.data( ), v.data( ), z.data( ) );
+		}
+
+		for ( uint32_t y = 0; y < height; y++ )
+		{
+			for ( uint32_t x = 0; x < width; x++ )
+			{
+				uint8_t& texel = texels[ y * pitch + x * stride ];
+				const size_t i = static_cast< size_t >( y ) * width + x;
+
+				// the edge runs half a texel before the nearest texel of the other side
+				float distance = texel > 127 ? sqrtf( to_outside[ i ] ) - 0.5f : 0.5f - sqrtf( to_inside[ i ] );
+
+				if ( texel > 0 && texel < 255 && fabsf( distance ) <= 0.5f )
+					distance = texel / 255.f - 0.5f;
+
+				const float alpha = 0.5f + distance / ( 2.f * daisy_sdf_spread );
+				texel = static_cast< uint8_t >( ( alpha < 0.f ? 0.f : ( alpha > 1.f ? 1.f : alpha ) ) * 255.f + 0.5f );
+			}
+		}
+	}
+
 	enum class daisy_call_kind : uint8_t
 	{
 		CALL_TRI = 0,
 		CALL_VTXSHADER,
 		CALL_PIXSHADER,
-		CALL_SCISSOR
+		CALL_SCISSOR,
+		CALL_RECT,
+		CALL_GLYPH,
+		CALL_SHAPE
 	};
 
 	enum daisy_text_align : uint16_t
@@ -170,11 +753,29 @@ namespace daisy
 		TEXT_ALIGNY_BOTTOM = 1 << 5,
 	};
 
+	// How c_renderqueue::push_path_stroke connects segments and ends open subpaths
+	enum daisy_line_join : uint8_t
+	{
+		LINE_JOIN_MITER = 0, // falls back to a bevel past the miter limit
+		LINE_JOIN_BEVEL,
+		LINE_JOIN_ROUND
+	};
+
+	enum daisy_line_cap : uint8_t
+	{
+		LINE_CAP_BUTT = 0,
+		LINE_CAP_SQUARE,
+		LINE_CAP_ROUND
+	};
+
 	enum daisy_font_flags : uint8_t
 	{
 		FONT_DEFAULT = 0,
 		FONT_BOLD = 1 << 0,
-		FONT_ITALIC = 1 << 1
+		FONT_ITALIC = 1 << 1,
+		FONT_LAZY = 1 << 2, // rasterize glyphs on first use instead of baking every glyph the font has, see c_fontwrapper::update
+		FONT_A8 = 1 << 3, // single-channel DXGI_FORMAT_A8_UNORM texture, a quarter of the BGRA memory
+		FONT_SDF = 1 << 4 // signed distance field atlas, drawn sharp at any size, see c_renderqueue::push_text
 	};
 
 	using uv_t = stl::array<float, 4>;
@@ -194,6 +795,34 @@ namespace daisy
 		float x { 0.f }, y { 0.f };
 	};
 
+	// Filled by c_fontwrapper::measure: texts[ i ] is m_extents[ i ] big and its lines are
+	// m_line_widths[ m_first_line[ i ] .. m_first_line[ i + 1 ] ) wide
+	struct daisy_text_measure_t
+	{
+		stl::vector<point_t> m_extents;
+		stl::vector<float> m_line_widths;
+		stl::vector<uint32_t> m_first_line;
+	};
+
+	// One image for c_texatlas::append_batch: width x height BGRA, tex_size bytes, tightly packed rows
+	struct daisy_atlas_image_t
+	{
+		uint32_t m_uuid;
+		point_t m_dimensions;
+		const uint8_t* m_tex_data;
+		uint32_t m_tex_size;
+	};
+
+	// Forward declarations
+	class c_fontwrapper;
+	class c_texatlas;
+	class c_imagecache;
+	class c_renderqueue;
+	class c_doublebuffer_queue;
+	class c_triplebuffer_queue;
+	class c_parallel_queue;
+	class c_daisy_backend;
+
 	struct daisy_drawcall_t
 	{
 		daisy_call_kind m_kind;
@@ -206,6 +835,18 @@ namespace daisy
 				uint32_t m_primitives, m_vertices, m_indices;
 			} m_tri;
 
+			struct
+			{
+				ID3D11ShaderResourceView* m_texture_srv;
+				uint32_t m_instances;
+			} m_rect;
+
+			struct
+			{
+				const c_fontwrapper* m_font;
+				uint32_t m_instances, m_page;
+			} m_glyph;
+
 			struct
 			{
 				void* m_shader_handle;
@@ -228,6 +869,20 @@ namespace daisy
 		static inline ID3D11VertexShader* s_vertex_shader = nullptr;
 		static inline ID3D11PixelShader* s_pixel_shader = nullptr;
 		static inline ID3D11InputLayout* s_input_layout = nullptr;
+
+		// Instanced rectangle pipeline (shares s_pixel_shader)
+		static inline ID3D11VertexShader* s_rect_vertex_shader = nullptr;
+		static inline ID3D11InputLayout* s_rect_input_layout = nullptr;
+		static inline ID3D11Buffer* s_unit_quad_vtx = nullptr;
+		static inline ID3D11Buffer* s_unit_quad_idx = nullptr;
+
+		// Shape pipeline: rect instances whose coverage comes from a rounded box distance (shares s_rect_input_layout)
+		static inline ID3D11VertexShader* s_shape_vertex_shader = nullptr;
+		static inline ID3D11PixelShader* s_shape_pixel_shader = nullptr;
+
+		// Instanced glyph pipeline (shares s_pixel_shader and the unit quad)
+		static inline ID3D11VertexShader* s_glyph_vertex_shader = nullptr;
+		static inline ID3D11InputLayout* s_glyph_input_layout = nullptr;
 		static inline ID3D11BlendState* s_blend_state = nullptr;
 		static inline ID3D11RasterizerState* s_rasterizer_state = nullptr;
 		static inline ID3D11DepthStencilState* s_depth_stencil_state = nullptr;
@@ -237,23 +892,57 @@ namespace daisy
 		static inline ID3D11Texture2D* s_white_texture = nullptr;
 		static inline ID3D11ShaderResourceView* s_white_texture_srv = nullptr;
 
+		// Texture array shared by registered fonts/atlases, see daisy_create_texture_array
+		// - slice 0 holds the white texture in its first texel
+		static inline ID3D11Texture2D* s_texture_array = nullptr;
+		static inline ID3D11ShaderResourceView* s_texture_array_srv = nullptr;
+		static inline ID3D11PixelShader* s_array_pixel_shader = nullptr;
+		static inline uint32_t s_texture_array_size = 0, s_texture_array_slices = 0, s_texture_array_used = 0;
+		static inline stl::unordered_map<ID3D11ShaderResourceView*, daisy_slice_t> s_texture_slices;
+		static inline stl::vector<uint32_t> s_texture_array_free; // slices of unregistered textures, reused first
+
+		// FONT_LAZY fonts, their new glyphs are uploaded on c_renderqueue::flush
+		// - s_lazy_fonts_lock guards the list, flush may run on another thread than the one creating fonts
+		static inline stl::vector<c_fontwrapper*> s_lazy_fonts;
+		static inline stl::mutex s_lazy_fonts_lock;
+
+		// Hands out c_fontwrapper::generation values, unique across every font's lifetime
+		static inline stl::atomic<uint32_t> s_font_generation { 0 };
+
+		// Baked font atlases are cached here when set, see daisy_set_font_cache
+		static inline stl::string s_font_cache_directory;
+
+		// FONT_SDF textures draw with their own pixel shader and a bilinear sampler
+		// - s_text_styles mirrors s_text_style_buffer, entry 0 is plain text
+		static inline stl::unordered_map<ID3D11ShaderResourceView*, const c_fontwrapper*> s_sdf_textures;
+		static inline ID3D11PixelShader* s_sdf_pixel_shader = nullptr;
+		static inline ID3D11SamplerState* s_linear_sampler_state = nullptr;
+		static inline ID3D11Buffer* s_text_style_buffer = nullptr;
+		static inline stl::vector<daisy_text_style_t> s_text_styles;
+
 		// Viewport dimensions (needed for vertex shader)
 		static inline float s_viewport_width = 1920.f;
 		static inline float s_viewport_height = 1080.f;
 	};
 
+	// Frees the texture array slice of a view registered with daisy_register_texture; fonts, atlases and image
+	// caches call this before releasing their views, so a new view at the same address doesn't draw the old slice
+	inline static void daisy_unregister_texture( ID3D11ShaderResourceView* texture_srv ) noexcept
+	{
+		const auto it = daisy_t::s_texture_slices.find( texture_srv );
+		if ( it == daisy_t::s_texture_slices.end( ) )
+			return;
+
+		daisy_t::s_texture_array_free.push_back( static_cast< uint32_t >( it->second.m_slice ) );
+		daisy_t::s_texture_slices.erase( it );
+	}
+
 	class c_daisy_resettable_object
 	{
 	public:
 		virtual bool reset( bool pre_reset = false ) noexcept = 0;
 	};
 
-	// Forward declarations
-	class c_fontwrapper;
-	class c_texatlas;
-	class c_renderqueue;
-	class c_doublebuffer_queue;
-
 	// Default shaders as string literals
 	namespace shaders
 	{
@@ -266,7 +955,7 @@ cbuffer ViewportBuffer : register(b0)
 
 struct VS_INPUT
 {
-    float4 pos : POSITION;
+    float3 pos : POSITION; // z carries the texture array slice
     float4 col : COLOR;
     float2 uv : TEXCOORD;
 };
@@ -276,6 +965,7 @@ struct PS_INPUT
     float4 pos : SV_POSITION;
     float4 col : COLOR;
     float2 uv : TEXCOORD;
+    nointerpolation float slice : SLICE;
 };
 
 PS_INPUT main(VS_INPUT input)
@@ -286,19 +976,34 @@ PS_INPUT main(VS_INPUT input)
     // D3D9 used pre-transformed coordinates (RHW), we need to transform here
     output.pos.x = (input.pos.x / ViewportSize.x) * 2.0f - 1.0f;
     output.pos.y = 1.0f - (input.pos.y / ViewportSize.y) * 2.0f;
-    output.pos.z = input.pos.z;
+    output.pos.z = 0.0f;
     output.pos.w = 1.0f;
     
     output.col = input.col;
     output.uv = input.uv;
+    output.slice = input.pos.z;
     
     return output;
 }
 )";
 
-		static const char* pixel_shader_src = R"(
-Texture2D tex : register(t0);
-SamplerState samp : register(s0);
+		static const char* rect_vertex_shader_src = R"(
+cbuffer ViewportBuffer : register(b0)
+{
+    float2 ViewportSize;
+    float2 _padding;
+};
+
+struct VS_INPUT
+{
+    float2 corner : CORNER; // unit quad, per vertex
+    float4 rect : RECT; // x, y, w, h, per instance
+    float4 col0 : COLOR0;
+    float4 col1 : COLOR1;
+    float4 col2 : COLOR2;
+    float4 col3 : COLOR3;
+    float4 uv : TEXCOORD; // uv mins, uv maxs
+};
 
 struct PS_INPUT
 {
@@ -307,652 +1012,4626 @@ struct PS_INPUT
     float2 uv : TEXCOORD;
 };
 
-float4 main(PS_INPUT input) : SV_TARGET
+PS_INPUT main(VS_INPUT input)
 {
-    float4 texColor = tex.Sample(samp, input.uv);
-    
-    // Use texture alpha as a mask for the vertex color
-    // This prevents anti-aliased text from appearing gray
-    float4 result = input.col;
-    result.a *= texColor.a;
-    
-    return result;
+    PS_INPUT output;
+
+    // Same snapping push_gradient_rectangle does on the CPU
+    float2 pos = floor(input.rect.xy + input.corner * input.rect.zw);
+
+    output.pos.x = (pos.x / ViewportSize.x) * 2.0f - 1.0f;
+    output.pos.y = 1.0f - (pos.y / ViewportSize.y) * 2.0f;
+    output.pos.z = 0.0f;
+    output.pos.w = 1.0f;
+
+    output.col = lerp(lerp(input.col0, input.col1, input.corner.x), lerp(input.col2, input.col3, input.corner.x), input.corner.y);
+    output.uv = lerp(input.uv.xy, input.uv.zw, input.corner);
+
+    return output;
 }
 )";
-	}
-
-	// Helper function to compile shaders
-	inline bool compile_shader( const char* source, const char* entry_point, const char* target, ID3DBlob** blob )
-	{
-		ID3DBlob* error_blob = nullptr;
-		HRESULT hr = D3DCompile( source, strlen( source ), nullptr, nullptr, nullptr,
-			entry_point, target, D3DCOMPILE_ENABLE_STRICTNESS, 0, blob, &error_blob );
 
-		if ( FAILED( hr ) )
-		{
-			if ( error_blob )
+		static const char* shape_vertex_shader_src = R"(
+cbuffer ViewportBuffer : register(b0)
+{
+    float2 ViewportSize;
+    float2 _padding;
+};
+
+struct VS_INPUT
+{
+    float2 corner : CORNER; // unit quad, per vertex
+    float4 rect : RECT; // x, y, w, h, per instance
+    float4 col0 : COLOR0; // fill
+    float4 col1 : COLOR1; // border
+    float4 col2 : COLOR2;
+    float4 col3 : COLOR3;
+    float4 uv : TEXCOORD; // radius, border width, softness
+};
+
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float2 local : TEXCOORD0; // pixels from the shape's center
+    nointerpolation float4 fill : COLOR0;
+    nointerpolation float4 border : COLOR1;
+    nointerpolation float4 shape : TEXCOORD1; // half size, radius, border width
+    nointerpolation float softness : TEXCOORD2;
+};
+
+PS_INPUT main(VS_INPUT input)
+{
+    PS_INPUT output;
+
+    // grown by half the edge ramp and a pixel so the falloff isn't cut off
+    float2 half_size = input.rect.zw * 0.5f;
+    float pad = max(input.uv.z, 1.0f) * 0.5f + 1.0f;
+
+    output.local = (input.corner * 2.0f - 1.0f) * (half_size + pad);
+    float2 pos = input.rect.xy + half_size + output.local;
+
+    output.pos.x = (pos.x / ViewportSize.x) * 2.0f - 1.0f;
+    output.pos.y = 1.0f - (pos.y / ViewportSize.y) * 2.0f;
+    output.pos.z = 0.0f;
+    output.pos.w = 1.0f;
+
+    output.fill = input.col0;
+    output.border = input.col1;
+    output.shape = float4(half_size, clamp(input.uv.x, 0.0f, min(half_size.x, half_size.y)), input.uv.y);
+    output.softness = input.uv.z;
+
+    return output;
+}
+)";
+
+		static const char* shape_pixel_shader_src = R"(
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float2 local : TEXCOORD0;
+    nointerpolation float4 fill : COLOR0;
+    nointerpolation float4 border : COLOR1;
+    nointerpolation float4 shape : TEXCOORD1;
+    nointerpolation float softness : TEXCOORD2;
+};
+
+// signed distance to a box of half_size with corners rounded by radius, negative inside
+float rounded_box(float2 p, float2 half_size, float radius)
+{
+    float2 q = abs(p) - half_size + radius;
+    return length(max(q, 0.0f)) + min(max(q.x, q.y), 0.0f) - radius;
+}
+
+float4 main(PS_INPUT input) : SV_TARGET
+{
+    float d = rounded_box(input.local, input.shape.xy, input.shape.z);
+    float w = max(input.softness, 1.0f);
+
+    float outer = saturate(0.5f - d / w);
+    float inner = input.shape.w > 0.0f ? saturate(0.5f - (d + input.shape.w) / w) : 1.0f;
+
+    // border inside the edge, mixed premultiplied so a transparent fill leaves a clean outline
+    float a = lerp(input.border.a, input.fill.a, inner);
+    float3 rgb = lerp(input.border.rgb * input.border.a, input.fill.rgb * input.fill.a, inner) / max(a, 1e-5f);
+
+    return float4(rgb, a * outer);
+}
+)";
+
+		static const char* glyph_vertex_shader_src = R"(
+cbuffer ViewportBuffer : register(b0)
+{
+    float2 ViewportSize;
+    float2 _padding;
+};
+
+struct Glyph
+{
+    float4 uv; // uv mins, uv maxs
+    float2 size; // pixels
+    float advance; // unused here
+};
+
+StructuredBuffer<Glyph> Glyphs : register(t0);
+
+struct VS_INPUT
+{
+    float2 corner : CORNER; // unit quad, per vertex
+    float2 pos : POSITION; // per instance
+    uint glyph : GLYPH;
+    float4 col : COLOR;
+};
+
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float4 col : COLOR;
+    float2 uv : TEXCOORD;
+};
+
+PS_INPUT main(VS_INPUT input)
+{
+    PS_INPUT output;
+
+    Glyph g = Glyphs[input.glyph];
+    float2 pos = input.pos + input.corner * g.size;
+
+    output.pos.x = (pos.x / ViewportSize.x) * 2.0f - 1.0f;
+    output.pos.y = 1.0f - (pos.y / ViewportSize.y) * 2.0f;
+    output.pos.z = 0.0f;
+    output.pos.w = 1.0f;
+
+    output.col = input.col;
+    output.uv = lerp(g.uv.xy, g.uv.zw, input.corner);
+
+    return output;
+}
+)";
+
+		static const char* pixel_shader_src = R"(
+Texture2D tex : register(t0);
+SamplerState samp : register(s0);
+
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float4 col : COLOR;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET
+{
+    float4 texColor = tex.Sample(samp, input.uv);
+    
+    // Use texture alpha as a mask for the vertex color
+    // This prevents anti-aliased text from appearing gray
+    // Only alpha is read, so FONT_A8 (A8_UNORM) fonts sample through here too
+    float4 result = input.col;
+    result.a *= texColor.a;
+    
+    return result;
+}
+)";
+
+		static const char* array_pixel_shader_src = R"(
+Texture2DArray tex : register(t0);
+SamplerState samp : register(s0);
+
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float4 col : COLOR;
+    float2 uv : TEXCOORD;
+    nointerpolation float slice : SLICE;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET
+{
+    float4 texColor = tex.Sample(samp, float3(input.uv, input.slice));
+
+    float4 result = input.col;
+    result.a *= texColor.a;
+
+    return result;
+}
+)";
+
+		static const char* sdf_pixel_shader_src = R"(
+Texture2D tex : register(t0);
+SamplerState samp : register(s0);
+
+// daisy_add_text_style, indexed by the slice the vertices carry
+cbuffer TextStyles : register(b0)
+{
+    float4 OutlineColor[16];
+    float4 GlowColor[16];
+    float4 Widths[16]; // x = outline, y = glow, in atlas texels
+};
+
+static const float Spread = 6.0f; // daisy_sdf_spread
+
+struct PS_INPUT
+{
+    float4 pos : SV_POSITION;
+    float4 col : COLOR;
+    float2 uv : TEXCOORD;
+    nointerpolation float slice : SLICE;
+};
+
+// straight alpha "over"
+float4 over(float4 top, float4 bottom)
+{
+    float a = top.a + bottom.a * (1.0f - top.a);
+    float3 rgb = (top.rgb * top.a + bottom.rgb * bottom.a * (1.0f - top.a)) / max(a, 1e-5f);
+    return float4(rgb, a);
+}
+
+float4 main(PS_INPUT input) : SV_TARGET
+{
+    uint style = min((uint)input.slice, 15u);
+
+    // distance to the glyph edge in atlas texels (positive inside) and how many of them one pixel spans
+    float d = (tex.Sample(samp, input.uv).a - 0.5f) * (2.0f * Spread);
+    float w = max(length(float2(ddx(d), ddy(d))), 1e-3f);
+
+    float outline = Widths[style].x;
+    float glow = Widths[style].y;
+
+    float4 fill = input.col;
+    fill.a *= saturate(d / w + 0.5f);
+
+    float4 edge = OutlineColor[style];
+    edge.a *= outline > 0.0f ? saturate((d + outline) / w + 0.5f) * input.col.a : 0.0f;
+
+    float4 halo = GlowColor[style];
+    halo.a *= glow > 0.0f ? saturate(1.0f + (d + outline) / glow) * input.col.a : 0.0f;
+
+    return over(fill, over(edge, halo));
+}
+)";
+	}
+
+	// Helper function to compile shaders
+	inline bool compile_shader( const char* source, const char* entry_point, const char* target, ID3DBlob** blob )
+	{
+		ID3DBlob* error_blob = nullptr;
+		HRESULT hr = D3DCompile( source, strlen( source ), nullptr, nullptr, nullptr,
+			entry_point, target, D3DCOMPILE_ENABLE_STRICTNESS, 0, blob, &error_blob );
+
+		if ( FAILED( hr ) )
+		{
+			if ( error_blob )
+			{
+				OutputDebugStringA( ( char* ) error_blob->GetBufferPointer( ) );
+				error_blob->Release( );
+			}
+			return false;
+		}
+
+		if ( error_blob )
+			error_blob->Release( );
+
+		return true;
+	}
+
+	// Font wrapper class
+	class c_fontwrapper : public c_daisy_resettable_object
+	{
+		friend class c_renderqueue;
+
+	private:
+		// glyph ids: a flat array for the code points below dense_glyph_range and a table sorted by
+		// code point for the rest, 0 is the null glyph
+		static constexpr uint32_t dense_glyph_range = 0x800;
+
+		// FONT_LAZY rasterizes into fixed-size pages that are never resized, so uvs already recorded stay valid,
+		// a full page opens the next one
+		static constexpr uint32_t lazy_page_size = 512;
+		static constexpr uint32_t lazy_max_pages = 64;
+
+		// On-disk atlas written by save_cache, followed by the dense ids, sparse ids, glyph table and BGRA pixels
+		// - m_checksum covers the header (with m_checksum 0) and everything after it, see cache_checksum
+		static constexpr uint32_t cache_magic = 0x46595344, cache_version = 3; // "DSYF"
+
+		struct cache_header_t
+		{
+			uint32_t m_magic, m_version;
+			uint64_t m_key;
+			uint32_t m_width, m_height, m_spacing, m_sparse_ids, m_glyphs;
+			float m_scale;
+			uint64_t m_checksum;
+		};
+
+		struct page_t
+		{
+			ID3D11Texture2D* m_texture = nullptr;
+			ID3D11ShaderResourceView* m_texture_srv = nullptr;
+			HBITMAP m_bitmap = nullptr;
+			DWORD* m_bits = nullptr;
+			uint32_t m_cursor_x = 0, m_cursor_y = 0, m_row_height = 0;
+			RECT m_dirty { }; // rasterized but not uploaded yet, empty when right <= left
+		};
+
+		// A dense id of 0 means a lazy font hasn't looked the code point up yet, missing_glyph that it lacks it;
+		// sparse misses are entries with id 0
+		static constexpr uint32_t missing_glyph = ~0u;
+
+		uint32_t m_dense_ids[ dense_glyph_range ];
+		stl::vector<stl::pair<uint32_t, uint32_t>> m_sparse_ids;
+		stl::vector<daisy_glyph_t> m_glyphs;
+		stl::vector<uint16_t> m_glyph_pages;
+		stl::vector<page_t> m_pages;
+		stl::vector<stl::pair<uint32_t, uint32_t>> m_ranges; // code points the font has, [first, last]
+		stl::vector<uint32_t> m_upload;
+		HDC m_gdi_ctx = nullptr;
+		HGDIOBJ m_gdi_font = nullptr, m_prev_gdi_font = nullptr, m_prev_bitmap = nullptr;
+
+		// Lazy fonts: held while a glyph is rasterized and by c_renderqueue::flush from update( ) until its
+		// drawcalls are submitted, so the recording thread can add glyphs while another thread flushes
+		stl::mutex m_lazy_lock;
+		uint32_t m_glyph_capacity = 0, m_uploaded_glyphs = 0;
+		stl::string_view m_family;
+		ID3D11Texture2D* m_texture = nullptr;
+		ID3D11ShaderResourceView* m_texture_srv = nullptr;
+		ID3D11Buffer* m_glyph_buffer = nullptr;
+		ID3D11ShaderResourceView* m_glyph_srv = nullptr;
+		float m_scale;
+		uint32_t m_width, m_height, m_spacing, m_size, m_quality;
+		uint32_t m_generation = next_generation( ); // renewed whenever the textures are released, see generation( )
+		uint8_t m_flags;
+
+		// measurement: advances of the ASCII glyphs and the optional memo, see set_measure_cache
+		struct measure_memo_t
+		{
+			stl::string m_units; // the measured code units, compared on every hit
+			uint32_t m_unit_size;
+			point_t m_extent;
+			stl::vector<float> m_line_widths;
+		};
+
+		float m_ascii_advances[ 128 ];
+		stl::unordered_map<uint64_t, measure_memo_t> m_measure_memo;
+		uint32_t m_measure_memo_capacity = 0;
+
+	private:
+		// Uploads the dirty page rectangles and new glyph table entries, the caller holds m_lazy_lock
+		bool upload_glyphs( ) noexcept
+		{
+			if ( this->m_pages.empty( ) || !this->m_texture )
+				return true;
+
+			bool flushed = false;
+
+			for ( auto& page : this->m_pages )
+			{
+				const RECT dirty = page.m_dirty;
+				if ( dirty.right <= dirty.left || dirty.bottom <= dirty.top )
+					continue;
+
+				if ( !flushed )
+				{
+					GdiFlush( );
+					flushed = true;
+				}
+
+				const uint32_t w = dirty.right - dirty.left, h = dirty.bottom - dirty.top;
+				const uint32_t texel_size = this->texel_size( );
+				this->m_upload.resize( ( static_cast< size_t >( w ) * h * texel_size + 3 ) / sizeof( uint32_t ) );
+
+				// same conversion as create_ex: white with the GDI intensity as alpha, or the alpha alone
+				uint8_t* dst = reinterpret_cast< uint8_t* >( this->m_upload.data( ) );
+				for ( uint32_t y = 0; y < h; y++ )
+				{
+					const DWORD* src = page.m_bits + static_cast< size_t >( dirty.top + y ) * lazy_page_size + dirty.left;
+					for ( uint32_t x = 0; x < w; x++ )
+					{
+						const DWORD pixel = src[ x ];
+						const BYTE intensity = static_cast< BYTE >( max( max( ( pixel >> 16 ) & 0xFF, ( pixel >> 8 ) & 0xFF ), pixel & 0xFF ) );
+
+						if ( texel_size == 1 )
+							*dst++ = intensity;
+						else
+						{
+							const uint32_t texel = ( static_cast< uint32_t >( intensity ) << 24 ) | 0x00FFFFFF;
+							memcpy( dst, &texel, sizeof( texel ) );
+							dst += sizeof( texel );
+						}
+					}
+				}
+
+				// whole glyph cells are dirty and their padding covers the spread, so the field of the rectangle is exact
+				this->finish_texels( reinterpret_cast< uint8_t* >( this->m_upload.data( ) ), w, h );
+
+				const D3D11_BOX box { static_cast< UINT >( dirty.left ), static_cast< UINT >( dirty.top ), 0, static_cast< UINT >( dirty.right ), static_cast< UINT >( dirty.bottom ), 1 };
+				daisy_t::s_context->UpdateSubresource( page.m_texture, 0, &box, this->m_upload.data( ), w * texel_size, 0 );
+
+				page.m_dirty = { };
+			}
+
+			const uint32_t count = static_cast< uint32_t >( this->m_glyphs.size( ) );
+
+			if ( count > this->m_glyph_capacity )
+			{
+				if ( this->m_glyph_srv )
+				{
+					this->m_glyph_srv->Release( );
+					this->m_glyph_srv = nullptr;
+				}
+				if ( this->m_glyph_buffer )
+				{
+					this->m_glyph_buffer->Release( );
+					this->m_glyph_buffer = nullptr;
+				}
+
+				if ( !this->create_glyph_buffer( max( 256u, count * 2 ) ) )
+					return false;
+			}
+
+			if ( count > this->m_uploaded_glyphs )
+			{
+				const D3D11_BOX box { static_cast< UINT >( this->m_uploaded_glyphs * sizeof( daisy_glyph_t ) ), 0, 0, static_cast< UINT >( count * sizeof( daisy_glyph_t ) ), 1, 1 };
+				daisy_t::s_context->UpdateSubresource( this->m_glyph_buffer, 0, &box, this->m_glyphs.data( ) + this->m_uploaded_glyphs, 0, 0 );
+
+				this->m_uploaded_glyphs = count;
+			}
+
+			return true;
+		}
+
+		void release_resources( ) noexcept
+		{
+			if ( m_texture_srv )
+			{
+				this->track_sdf_texture( m_texture_srv, false );
+				daisy_unregister_texture( m_texture_srv );
+				m_texture_srv->Release( );
+				m_texture_srv = nullptr;
+			}
+			if ( m_texture )
+			{
+				m_texture->Release( );
+				m_texture = nullptr;
+			}
+			if ( m_glyph_srv )
+			{
+				m_glyph_srv->Release( );
+				m_glyph_srv = nullptr;
+			}
+			if ( m_glyph_buffer )
+			{
+				m_glyph_buffer->Release( );
+				m_glyph_buffer = nullptr;
+			}
+
+			for ( auto& page : this->m_pages )
+			{
+				if ( page.m_texture_srv )
+				{
+					this->track_sdf_texture( page.m_texture_srv, false );
+					daisy_unregister_texture( page.m_texture_srv );
+					page.m_texture_srv->Release( );
+					page.m_texture_srv = nullptr;
+				}
+				if ( page.m_texture )
+				{
+					page.m_texture->Release( );
+					page.m_texture = nullptr;
+				}
+			}
+
+			this->m_glyph_capacity = this->m_uploaded_glyphs = 0;
+			this->m_generation = next_generation( );
+		}
+
+		static uint32_t next_generation( ) noexcept
+		{
+			return daisy_t::s_font_generation.fetch_add( 1, stl::memory_order_relaxed ) + 1;
+		}
+
+		// Lazy fonts keep their DC and page bitmaps alive to rasterize into
+		void release_gdi( ) noexcept
+		{
+			if ( !this->m_gdi_ctx )
+				return;
+
+			SelectObject( this->m_gdi_ctx, this->m_prev_bitmap );
+			SelectObject( this->m_gdi_ctx, this->m_prev_gdi_font );
+
+			for ( auto& page : this->m_pages )
+				DeleteObject( page.m_bitmap );
+
+			DeleteObject( this->m_gdi_font );
+			DeleteDC( this->m_gdi_ctx );
+
+			this->m_pages.clear( );
+			this->m_glyph_pages.clear( );
+			this->m_ranges.clear( );
+			this->m_gdi_ctx = nullptr;
+			this->m_gdi_font = this->m_prev_gdi_font = this->m_prev_bitmap = nullptr;
+
+			stl::lock_guard<stl::mutex> lock( daisy_t::s_lazy_fonts_lock );
+			auto& fonts = daisy_t::s_lazy_fonts;
+			fonts.erase( stl::remove( fonts.begin( ), fonts.end( ), this ), fonts.end( ) );
+		}
+
+		// Lazy fonts get a DEFAULT buffer with room to grow, update( ) fills it
+		bool create_glyph_buffer( uint32_t capacity ) noexcept
+		{
+			const bool lazy = !this->m_pages.empty( );
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = static_cast< UINT >( sizeof( daisy_glyph_t ) * capacity );
+			desc.Usage = lazy ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+			desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+			desc.StructureByteStride = sizeof( daisy_glyph_t );
+
+			D3D11_SUBRESOURCE_DATA init_data = {};
+			init_data.pSysMem = this->m_glyphs.data( );
+
+			if ( FAILED( daisy_t::s_device->CreateBuffer( &desc, lazy ? nullptr : &init_data, &this->m_glyph_buffer ) ) )
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+			srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			srv_desc.Buffer.FirstElement = 0;
+			srv_desc.Buffer.NumElements = capacity;
+
+			if ( FAILED( daisy_t::s_device->CreateShaderResourceView( this->m_glyph_buffer, &srv_desc, &this->m_glyph_srv ) ) )
+				return false;
+
+			this->m_glyph_capacity = capacity;
+			this->m_uploaded_glyphs = lazy ? 0 : capacity;
+
+			return true;
+		}
+
+		// Whole page is marked dirty, update( ) uploads it on the next flush
+		bool create_page_texture( page_t& page ) const noexcept
+		{
+			D3D11_TEXTURE2D_DESC tex_desc = {};
+			tex_desc.Width = tex_desc.Height = lazy_page_size;
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = this->texture_format( );
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.Usage = D3D11_USAGE_DEFAULT;
+			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+			if ( FAILED( daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &page.m_texture ) ) || !page.m_texture )
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+			srv_desc.Format = tex_desc.Format;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srv_desc.Texture2D.MipLevels = 1;
+
+			if ( FAILED( daisy_t::s_device->CreateShaderResourceView( page.m_texture, &srv_desc, &page.m_texture_srv ) ) )
+				return false;
+
+			this->track_sdf_texture( page.m_texture_srv, true );
+			page.m_dirty = { 0, 0, static_cast< LONG >( lazy_page_size ), static_cast< LONG >( lazy_page_size ) };
+			return true;
+		}
+
+		bool add_page( ) noexcept
+		{
+			if ( this->m_pages.size( ) >= lazy_max_pages )
+				return false;
+
+			page_t page {};
+
+			BITMAPINFO bitmap_ctx {};
+			bitmap_ctx.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+			bitmap_ctx.bmiHeader.biWidth = lazy_page_size;
+			bitmap_ctx.bmiHeader.biHeight = -static_cast< int32_t >( lazy_page_size );
+			bitmap_ctx.bmiHeader.biPlanes = 1;
+			bitmap_ctx.bmiHeader.biCompression = BI_RGB;
+			bitmap_ctx.bmiHeader.biBitCount = 32;
+
+			page.m_bitmap = CreateDIBSection( this->m_gdi_ctx, &bitmap_ctx, DIB_RGB_COLORS, reinterpret_cast< void** >( &page.m_bits ), nullptr, 0 );
+			if ( !page.m_bitmap || !page.m_bits )
+				return false;
+
+			memset( page.m_bits, 0, sizeof( DWORD ) * lazy_page_size * lazy_page_size );
+
+			if ( !this->create_page_texture( page ) )
+			{
+				if ( page.m_texture_srv )
+				{
+					this->track_sdf_texture( page.m_texture_srv, false );
+					page.m_texture_srv->Release( );
+				}
+				if ( page.m_texture )
+					page.m_texture->Release( );
+
+				DeleteObject( page.m_bitmap );
+				return false;
+			}
+
+			page.m_cursor_x = this->m_spacing;
+			page.m_cursor_y = this->glyph_margin( );
+			this->m_pages.push_back( page );
+
+			return true;
+		}
+
+		// decoded code points are 32-bit, narrowing them through a 16-bit wchar_t would alias other glyphs
+		template <typename t>
+		static uint32_t code_point( t glyph ) noexcept
+		{
+			return sizeof( t ) == 4 ? static_cast< uint32_t >( glyph ) : static_cast< uint32_t >( static_cast< wchar_t >( glyph ) );
+		}
+
+		// Glyph id of a code point from the tables, false when a lazy font hasn't looked it up yet
+		bool find_glyph( uint32_t code, uint32_t& id ) const noexcept
+		{
+			if ( code < dense_glyph_range )
+			{
+				id = this->m_dense_ids[ code ];
+
+				if ( id == missing_glyph )
+				{
+					id = 0;
+					return true;
+				}
+
+				// lazy fonts are the only ones with pages
+				return id || this->m_pages.empty( );
+			}
+
+			const auto it = stl::lower_bound( this->m_sparse_ids.begin( ), this->m_sparse_ids.end( ), stl::pair<uint32_t, uint32_t> { code, 0 } );
+			const bool found = it != this->m_sparse_ids.end( ) && it->first == code;
+
+			id = found ? it->second : 0;
+			return found || this->m_pages.empty( );
+		}
+
+		bool supports( uint32_t code ) const noexcept
+		{
+			const auto it = stl::upper_bound( this->m_ranges.begin( ), this->m_ranges.end( ), stl::pair<uint32_t, uint32_t> { code, ~0u } );
+			return it != this->m_ranges.begin( ) && code <= ( it - 1 )->second;
+		}
+
+		// Rasterizes a glyph of a lazy font, returns its id or 0; either way the code point is never looked up again
+		uint32_t rasterize_glyph( uint32_t code ) noexcept
+		{
+			stl::lock_guard<stl::mutex> lock( this->m_lazy_lock );
+
+			const uint32_t id = this->paint_glyph( code );
+
+			if ( code < dense_glyph_range )
+				this->m_dense_ids[ code ] = id ? id : missing_glyph;
+			else
+			{
+				const stl::pair<uint32_t, uint32_t> entry { code, id };
+				this->m_sparse_ids.insert( stl::lower_bound( this->m_sparse_ids.begin( ), this->m_sparse_ids.end( ), entry ), entry );
+			}
+
+			return id;
+		}
+
+		// Paints a glyph into the current page and appends it to the glyph table, returns its id or 0
+		uint32_t paint_glyph( uint32_t code ) noexcept
+		{
+			if ( code > 0xFFFF || !this->supports( code ) )
+				return 0;
+
+			const wchar_t ch = static_cast< wchar_t >( code );
+
+			SIZE size;
+			if ( !GetTextExtentPoint32W( this->m_gdi_ctx, &ch, 1, &size ) )
+				return 0;
+
+			const uint32_t margin = this->glyph_margin( );
+
+			if ( static_cast< uint32_t >( size.cx ) + 2 * this->m_spacing > lazy_page_size || static_cast< uint32_t >( size.cy ) + 2 * margin > lazy_page_size )
+				return 0;
+
+			page_t* page = &this->m_pages.back( );
+
+			if ( page->m_cursor_x + size.cx + this->m_spacing > lazy_page_size )
+			{
+				page->m_cursor_x = this->m_spacing;
+				page->m_cursor_y += page->m_row_height + this->row_gap( );
+				page->m_row_height = 0;
+			}
+
+			if ( page->m_cursor_y + size.cy + margin > lazy_page_size )
+			{
+				if ( !this->add_page( ) )
+					return 0;
+
+				page = &this->m_pages.back( );
+			}
+
+			const uint32_t x = page->m_cursor_x, y = page->m_cursor_y;
+
+			SelectObject( this->m_gdi_ctx, page->m_bitmap );
+
+			if ( !ExtTextOutW( this->m_gdi_ctx, x, y, ETO_OPAQUE, nullptr, &ch, 1, nullptr ) )
+				return 0;
+
+			daisy_glyph_t glyph {};
+			glyph.m_uv[ 0 ] = static_cast< float >( x - this->m_spacing ) / lazy_page_size;
+			glyph.m_uv[ 1 ] = static_cast< float >( y ) / lazy_page_size;
+			glyph.m_uv[ 2 ] = static_cast< float >( x + size.cx + this->m_spacing ) / lazy_page_size;
+			glyph.m_uv[ 3 ] = static_cast< float >( y + size.cy ) / lazy_page_size;
+			glyph.m_size[ 0 ] = ( glyph.m_uv[ 2 ] - glyph.m_uv[ 0 ] ) * lazy_page_size;
+			glyph.m_size[ 1 ] = ( glyph.m_uv[ 3 ] - glyph.m_uv[ 1 ] ) * lazy_page_size;
+			glyph.m_advance = glyph.m_size[ 0 ] - 2.f * this->m_spacing + 1.f;
+
+			// grow the dirty rectangle by the glyph cell and its margin, SDF quads sample the field there too
+			RECT& dirty = page->m_dirty;
+			const RECT cell { static_cast< LONG >( x - this->m_spacing ), static_cast< LONG >( y - margin ), static_cast< LONG >( x + size.cx + this->m_spacing ), static_cast< LONG >( y + size.cy + margin ) };
+
+			if ( dirty.right <= dirty.left )
+				dirty = cell;
+			else
+			{
+				dirty.left = min( dirty.left, cell.left );
+				dirty.top = min( dirty.top, cell.top );
+				dirty.right = max( dirty.right, cell.right );
+				dirty.bottom = max( dirty.bottom, cell.bottom );
+			}
+
+			page->m_cursor_x += size.cx + ( 2 * this->m_spacing );
+			page->m_row_height = max( page->m_row_height, static_cast< uint32_t >( size.cy ) );
+
+			const uint32_t id = static_cast< uint32_t >( this->m_glyphs.size( ) );
+
+			this->m_glyphs.push_back( glyph );
+			this->m_glyph_pages.push_back( static_cast< uint16_t >( this->m_pages.size( ) - 1 ) );
+
+			return id;
+		}
+
+		// Sets up the DC and first page instead of baking the alphabet, printable ASCII is rasterized up front
+		bool create_lazy( ) noexcept
+		{
+			if ( !this->m_gdi_ctx )
+			{
+				this->m_gdi_ctx = CreateCompatibleDC( nullptr );
+				SetMapMode( this->m_gdi_ctx, MM_TEXT );
+
+				this->create_gdi_font( this->m_gdi_ctx, &this->m_gdi_font );
+				this->m_prev_gdi_font = SelectObject( this->m_gdi_ctx, this->m_gdi_font );
+
+				SIZE size;
+				wchar_t chr[ ] = L"x\0\0";
+
+				if ( !GetTextExtentPoint32W( this->m_gdi_ctx, chr, 1, &size ) )
+					return false;
+
+				const auto unicode_ranges_size = GetFontUnicodeRanges( this->m_gdi_ctx, nullptr );
+				if ( !unicode_ranges_size )
+					return false;
+
+				auto glyph_sets_memory = stl::make_unique<uint8_t[ ]>( unicode_ranges_size );
+				auto glyph_sets = reinterpret_cast< GLYPHSET* >( glyph_sets_memory.get( ) );
+
+				if ( !GetFontUnicodeRanges( this->m_gdi_ctx, glyph_sets ) )
+					return false;
+
+				for ( uint32_t r = 0; r < glyph_sets->cRanges; ++r )
+				{
+					if ( glyph_sets->ranges[ r ].cGlyphs )
+						this->m_ranges.emplace_back( glyph_sets->ranges[ r ].wcLow, glyph_sets->ranges[ r ].wcLow + glyph_sets->ranges[ r ].cGlyphs - 1u );
+				}
+
+				stl::sort( this->m_ranges.begin( ), this->m_ranges.end( ) );
+
+				this->m_spacing = this->glyph_spacing( size.cy );
+				this->m_scale = 1.f;
+				this->m_width = this->m_height = lazy_page_size;
+
+				SetTextColor( this->m_gdi_ctx, RGB( 255, 255, 255 ) );
+				SetBkColor( this->m_gdi_ctx, 0x00000000 );
+				SetBkMode( this->m_gdi_ctx, OPAQUE );
+				SetTextAlign( this->m_gdi_ctx, TA_TOP );
+
+				memset( this->m_dense_ids, 0, sizeof( this->m_dense_ids ) );
+				this->m_sparse_ids.clear( );
+				this->m_glyphs.assign( 1, daisy_glyph_t { { }, { 0.f, 0.f }, 1.f - 2.f * this->m_spacing } );
+				this->m_glyph_pages.assign( 1, 0 );
+
+				if ( !this->add_page( ) )
+					return false;
+
+				this->m_prev_bitmap = SelectObject( this->m_gdi_ctx, this->m_pages.back( ).m_bitmap );
+
+				for ( uint32_t c = ' '; c < 127; ++c )
+					this->rasterize_glyph( c );
+
+				stl::lock_guard<stl::mutex> lock( daisy_t::s_lazy_fonts_lock );
+				daisy_t::s_lazy_fonts.push_back( this );
+			}
+			else
+			{
+				// device reset: the glyphs survive in the page bitmaps, only the textures are recreated
+				for ( auto& page : this->m_pages )
+				{
+					if ( !this->create_page_texture( page ) )
+						return false;
+				}
+			}
+
+			// texture( )/texture_srv( ) are page 0
+			this->m_texture = this->m_pages.front( ).m_texture;
+			this->m_texture->AddRef( );
+			this->m_texture_srv = this->m_pages.front( ).m_texture_srv;
+			this->m_texture_srv->AddRef( );
+
+			return this->update( );
+		}
+
+		// SDF glyphs need room for the distance field around them, in both directions
+		uint32_t glyph_spacing( LONG height ) const noexcept
+		{
+			const uint32_t spacing = static_cast< uint32_t >( ceil( height * 0.3f ) );
+			return ( this->m_flags & FONT_SDF ) ? max( spacing, static_cast< uint32_t >( 2.f * daisy_sdf_spread ) ) : spacing;
+		}
+		uint32_t row_gap( ) const noexcept
+		{
+			return 1 + 2 * this->glyph_margin( );
+		}
+
+		// Converted atlas texels: coverage, or the distance field of it for FONT_SDF
+		// - texels are stride bytes apart, the alpha byte of BGRA or the A8 texel itself
+		void finish_texels( uint8_t* pixels, uint32_t width, uint32_t height ) const noexcept
+		{
+			if ( !( this->m_flags & FONT_SDF ) )
+				return;
+
+			const uint32_t texel_size = this->texel_size( );
+			daisy_distance_field( pixels + ( texel_size - 1 ), width, height, texel_size, static_cast< size_t >( width ) * texel_size );
+		}
+
+		// SDF textures are looked up by flush( ) and the CPU backend to pick the distance test
+		void track_sdf_texture( ID3D11ShaderResourceView* texture_srv, bool add ) const noexcept
+		{
+			if ( !texture_srv || !( this->m_flags & FONT_SDF ) )
+				return;
+
+			if ( add )
+				daisy_t::s_sdf_textures[ texture_srv ] = this;
+			else
+				daisy_t::s_sdf_textures.erase( texture_srv );
+		}
+
+		// Caches the ASCII advances once the glyph table is final, ASCII glyphs of lazy fonts are rasterized up front
+		void build_advances( ) noexcept
+		{
+			for ( uint32_t c = 0; c < 128; c++ )
+				this->m_ascii_advances[ c ] = this->measured_advance( this->glyph( this->glyph_id( static_cast< char >( c ) ) ) );
+
+			this->m_measure_memo.clear( );
+		}
+
+		// text_extent measures in atlas pixels, while the glyph table's sizes and advances are divided by m_scale
+		// for drawing; the two only differ for fonts whose atlas had to be scaled down
+		float measured_advance( const daisy_glyph_t& glyph ) const noexcept
+		{
+			if ( this->m_scale == 1.f )
+				return glyph.m_advance;
+
+			return ( glyph.m_uv[ 2 ] - glyph.m_uv[ 0 ] ) * this->m_width - 2.f * this->m_spacing + 1.f;
+		}
+
+		// Advance of a code point, control characters don't move the pen
+		float advance( uint32_t code, bool& pen_moved_back ) noexcept
+		{
+			if ( code < ' ' )
+				return 0.f;
+
+			const float advance = code < 128 ? this->m_ascii_advances[ code ] : this->measured_advance( this->glyph( this->glyph_id( code ) ) );
+
+			pen_moved_back |= advance < 0.f;
+			return advance;
+		}
+
+		// Widest pen position of one line like text_extent, summed in 4 lanes so the adds pipeline
+		// - only the null glyph has a negative advance, a line with one is walked again for the widest position
+		template <typename c>
+		float line_width( const c* begin, const c* end ) noexcept
+		{
+			float lanes[ 4 ] = { };
+			bool pen_moved_back = false;
+
+			daisy_code_points_t<c> points( begin, end );
+			uint32_t code;
+
+			for ( uint32_t i = 0; points.next( code ); i++ )
+				lanes[ i & 3 ] += this->advance( code, pen_moved_back );
+
+			if ( !pen_moved_back )
+				return ( lanes[ 0 ] + lanes[ 1 ] ) + ( lanes[ 2 ] + lanes[ 3 ] );
+
+			float row_width = 0.f, width = 0.f;
+
+			for ( daisy_code_points_t<c> again( begin, end ); again.next( code ); )
+			{
+				row_width += this->advance( code, pen_moved_back );
+				width = max( width, row_width );
+			}
+
+			return width;
+		}
+
+		// Extent of text, the width of every line is appended to line_widths when given
+		template <typename t>
+		point_t measure_lines( const t& text, stl::vector<float>* line_widths ) noexcept
+		{
+			const auto& space = this->glyph( this->glyph_id( ' ' ) );
+			const float row_height = this->m_scale == 1.f ? space.m_size[ 1 ] : ( space.m_uv[ 3 ] - space.m_uv[ 1 ] ) * this->m_height;
+			point_t extent { 0.f, row_height };
+
+			const auto* begin = text.data( );
+			const auto* const end = begin + text.size( );
+
+			while ( true )
+			{
+				const auto* line_end = stl::find( begin, end, '\n' );
+				const float width = this->line_width( begin, line_end );
+
+				if ( line_widths )
+					line_widths->push_back( width );
+
+				extent.x = max( extent.x, width );
+
+				if ( line_end == end )
+					break;
+
+				extent.y += row_height;
+				begin = line_end + 1;
+			}
+
+			return extent;
+		}
+
+		// The memo entry of text, measured now when it isn't in there yet
+		template <typename t>
+		const measure_memo_t& memoized( const t& text ) noexcept
+		{
+			const stl::string_view units( reinterpret_cast< const char* >( text.data( ) ), text.size( ) * sizeof( text[ 0 ] ) );
+			const uint64_t key = daisy_hash( reinterpret_cast< const uint8_t* >( units.data( ) ), units.size( ) ) ^ sizeof( text[ 0 ] );
+
+			const auto it = this->m_measure_memo.find( key );
+			if ( it != this->m_measure_memo.end( ) && it->second.m_unit_size == sizeof( text[ 0 ] ) && it->second.m_units == units )
+				return it->second;
+
+			// a full memo starts over rather than tracking use, a hash collision replaces the entry that had the key
+			if ( it == this->m_measure_memo.end( ) && this->m_measure_memo.size( ) >= this->m_measure_memo_capacity )
+				this->m_measure_memo.clear( );
+
+			auto& memo = this->m_measure_memo[ key ];
+			memo.m_units.assign( units.data( ), units.size( ) );
+			memo.m_unit_size = sizeof( text[ 0 ] );
+			memo.m_line_widths.clear( );
+			memo.m_extent = this->measure_lines( text, &memo.m_line_widths );
+
+			return memo;
+		}
+
+		// Only the alpha channel carries coverage, the pixel shaders ignore the texture's rgb
+		uint32_t texel_size( ) const noexcept
+		{
+			return ( this->m_flags & FONT_A8 ) ? 1 : 4;
+		}
+
+		// Atlas texture of a baked font, written once so it is immutable
+		// - pixels are white with the intensity as alpha, or just the alpha for FONT_A8
+		bool create_texture( const void* pixels ) noexcept
+		{
+			D3D11_TEXTURE2D_DESC tex_desc = {};
+			tex_desc.Width = this->m_width;
+			tex_desc.Height = this->m_height;
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = this->texture_format( );
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.Usage = D3D11_USAGE_IMMUTABLE;
+			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+			D3D11_SUBRESOURCE_DATA init_data = {};
+			init_data.pSysMem = pixels;
+			init_data.SysMemPitch = this->m_width * this->texel_size( );
+
+			HRESULT hr = daisy_t::s_device->CreateTexture2D( &tex_desc, &init_data, &this->m_texture );
+			if ( FAILED( hr ) || !this->m_texture )
+				return false;
+
+			// Create shader resource view
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+			srv_desc.Format = tex_desc.Format;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srv_desc.Texture2D.MipLevels = 1;
+
+			hr = daisy_t::s_device->CreateShaderResourceView( this->m_texture, &srv_desc, &this->m_texture_srv );
+			if ( FAILED( hr ) )
+				return false;
+
+			this->track_sdf_texture( this->m_texture_srv, true );
+			return true;
+		}
+
+		// Identifies a baked atlas: family, the face GDI actually selected, size, quality, flags and the size of the font
+		// file, which changes with most font updates (GDI_ERROR for non-TrueType fonts, the face name tells those apart)
+		uint64_t cache_key( HDC context ) const noexcept
+		{
+			const uint32_t params[ ] = { this->m_size, this->m_quality, this->m_flags, static_cast< uint32_t >( GetFontData( context, 0, 0, nullptr, 0 ) ),
+				cache_version, static_cast< uint32_t >( sizeof( daisy_glyph_t ) ), dense_glyph_range };
+
+			char face[ LF_FACESIZE ] = { };
+			GetTextFaceA( context, LF_FACESIZE, face );
+
+			stl::string key( this->m_family );
+			key.push_back( '\0' );
+			key.append( face );
+			key.append( reinterpret_cast< const char* >( params ), sizeof( params ) );
+
+			return daisy_hash( reinterpret_cast< const uint8_t* >( key.data( ) ), key.size( ) );
+		}
+
+		stl::string cache_path( uint64_t key ) const noexcept
+		{
+			const auto& directory = daisy_t::s_font_cache_directory;
+			const bool separated = !directory.empty( ) && ( directory.back( ) == '\\' || directory.back( ) == '/' );
+
+			char name[ 32 ];
+			snprintf( name, sizeof( name ), "%sdaisy_%016llx.font", separated ? "" : "\\", static_cast< unsigned long long >( key ) );
+
+			return directory + name;
+		}
+
+		// Hash of the header and each section, save_cache and read_cache must agree on it
+		static uint64_t cache_checksum( cache_header_t header, const void* dense, const void* sparse, size_t sparse_bytes, const void* glyphs,
+			size_t glyph_bytes, const void* pixels, size_t pixel_bytes ) noexcept
+		{
+			header.m_checksum = 0;
+
+			const uint64_t sections[ ] = { daisy_hash( reinterpret_cast< const uint8_t* >( &header ), sizeof( header ) ),
+				daisy_hash( static_cast< const uint8_t* >( dense ), sizeof( m_dense_ids ) ), daisy_hash( static_cast< const uint8_t* >( sparse ), sparse_bytes ),
+				daisy_hash( static_cast< const uint8_t* >( glyphs ), glyph_bytes ), daisy_hash( static_cast< const uint8_t* >( pixels ), pixel_bytes ) };
+
+			return daisy_hash( reinterpret_cast< const uint8_t* >( sections ), sizeof( sections ) );
+		}
+
+		// Takes the atlas from a mapped cache file, the pixels are uploaded straight from the mapping
+		// - anything that fails the checksum, has unsorted sparse ids or an implausible scale/spacing is baked again
+		bool read_cache( uint64_t key, const uint8_t* data, uint64_t size ) noexcept
+		{
+			cache_header_t header;
+			memcpy( &header, data, sizeof( header ) );
+
+			if ( header.m_magic != cache_magic || header.m_version != cache_version || header.m_key != key || !header.m_glyphs ||
+				!header.m_width || !header.m_height || header.m_width > 16384 || header.m_height > 16384 )
+				return false;
+
+			if ( !( header.m_scale > 0.f && header.m_scale <= 1.f ) || header.m_spacing > header.m_width )
+				return false;
+
+			const uint64_t dense_bytes = sizeof( this->m_dense_ids );
+			const uint64_t sparse_bytes = static_cast< uint64_t >( header.m_sparse_ids ) * sizeof( stl::pair<uint32_t, uint32_t> );
+			const uint64_t glyph_bytes = static_cast< uint64_t >( header.m_glyphs ) * sizeof( daisy_glyph_t );
+			const uint64_t pixel_bytes = static_cast< uint64_t >( header.m_width ) * header.m_height * this->texel_size( );
+
+			if ( size != sizeof( header ) + dense_bytes + sparse_bytes + glyph_bytes + pixel_bytes )
+				return false;
+
+			const uint8_t* dense = data + sizeof( header );
+			const uint8_t* sparse = dense + dense_bytes;
+			const uint8_t* glyphs = sparse + sparse_bytes;
+			const uint8_t* pixels = glyphs + glyph_bytes;
+
+			if ( header.m_checksum != cache_checksum( header, dense, sparse, static_cast< size_t >( sparse_bytes ), glyphs, static_cast< size_t >( glyph_bytes ),
+				pixels, static_cast< size_t >( pixel_bytes ) ) )
+				return false;
+
+			data += sizeof( header );
+
+			memcpy( this->m_dense_ids, data, dense_bytes );
+			data += dense_bytes;
+
+			this->m_sparse_ids.resize( header.m_sparse_ids );
+			memcpy( static_cast< void* >( this->m_sparse_ids.data( ) ), data, sparse_bytes );
+			data += sparse_bytes;
+
+			// glyph_id binary searches them
+			for ( size_t i = 1; i < this->m_sparse_ids.size( ); i++ )
+			{
+				if ( this->m_sparse_ids[ i - 1 ].first >= this->m_sparse_ids[ i ].first )
+					return false;
+			}
+
+			this->m_glyphs.resize( header.m_glyphs );
+			memcpy( this->m_glyphs.data( ), data, glyph_bytes );
+			data += glyph_bytes;
+
+			this->m_width = header.m_width;
+			this->m_height = header.m_height;
+			this->m_spacing = header.m_spacing;
+			this->m_scale = header.m_scale;
+
+			return this->create_texture( data ) && this->create_glyph_buffer( header.m_glyphs );
+		}
+
+		bool load_cache( uint64_t key ) noexcept
+		{
+			if ( daisy_t::s_font_cache_directory.empty( ) )
+				return false;
+
+			HANDLE file = CreateFileA( this->cache_path( key ).c_str( ), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+			if ( file == INVALID_HANDLE_VALUE )
+				return false;
+
+			LARGE_INTEGER size {};
+			HANDLE mapping = nullptr;
+			const uint8_t* view = nullptr;
+
+			if ( GetFileSizeEx( file, &size ) && static_cast< uint64_t >( size.QuadPart ) > sizeof( cache_header_t ) )
+				mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+			if ( mapping )
+				view = static_cast< const uint8_t* >( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+			const bool loaded = view && this->read_cache( key, view, static_cast< uint64_t >( size.QuadPart ) );
+
+			if ( view )
+				UnmapViewOfFile( view );
+			if ( mapping )
+				CloseHandle( mapping );
+			CloseHandle( file );
+
+			// a stale or broken file leaves nothing half-loaded behind, the atlas is baked again
+			if ( !loaded )
+				this->release_resources( );
+
+			return loaded;
+		}
+
+		// Written to a temporary file first so a crash or another process never sees a partial atlas
+		void save_cache( uint64_t key, const void* pixels ) const noexcept
+		{
+			cache_header_t header { cache_magic, cache_version, key, this->m_width, this->m_height, this->m_spacing,
+				static_cast< uint32_t >( this->m_sparse_ids.size( ) ), static_cast< uint32_t >( this->m_glyphs.size( ) ), this->m_scale, 0 };
+
+			header.m_checksum = cache_checksum( header, this->m_dense_ids, this->m_sparse_ids.data( ), this->m_sparse_ids.size( ) * sizeof( stl::pair<uint32_t, uint32_t> ),
+				this->m_glyphs.data( ), this->m_glyphs.size( ) * sizeof( daisy_glyph_t ), pixels, static_cast< size_t >( this->m_width ) * this->m_height * this->texel_size( ) );
+
+			const stl::string path = this->cache_path( key );
+			const stl::string temp_path = path + ".tmp";
+
+			HANDLE file = CreateFileA( temp_path.c_str( ), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+			if ( file == INVALID_HANDLE_VALUE )
+				return;
+
+			const auto write = [ file ]( const void* data, size_t size ) noexcept
+			{
+				DWORD written = 0;
+				return WriteFile( file, data, static_cast< DWORD >( size ), &written, nullptr ) && written == size;
+			};
+
+			const bool written = write( &header, sizeof( header ) ) && write( this->m_dense_ids, sizeof( this->m_dense_ids ) ) &&
+				write( this->m_sparse_ids.data( ), this->m_sparse_ids.size( ) * sizeof( stl::pair<uint32_t, uint32_t> ) ) &&
+				write( this->m_glyphs.data( ), this->m_glyphs.size( ) * sizeof( daisy_glyph_t ) ) &&
+				write( pixels, static_cast< size_t >( this->m_width ) * this->m_height * this->texel_size( ) );
+
+			CloseHandle( file );
+
+			if ( !written || !MoveFileExA( temp_path.c_str( ), path.c_str( ), MOVEFILE_REPLACE_EXISTING ) )
+				DeleteFileA( temp_path.c_str( ) );
+		}
+
+		bool create_ex( ) noexcept
+		{
+			if ( !daisy_t::s_device )
+				return false;
+
+			HDC gdi_ctx = nullptr;
+			HGDIOBJ gdi_font = nullptr, prev_gdi_font = nullptr, prev_bitmap = nullptr;
+			HBITMAP bitmap = nullptr;
+
+			// Release old texture if exists
+			this->release_resources( );
+
+			if ( this->m_flags & FONT_LAZY )
+				return this->create_lazy( );
+
+			gdi_ctx = CreateCompatibleDC( nullptr );
+			SetMapMode( gdi_ctx, MM_TEXT );
+
+			this->create_gdi_font( gdi_ctx, &gdi_font );
+			prev_gdi_font = SelectObject( gdi_ctx, gdi_font );
+
+			// a cached atlas skips measuring and painting altogether
+			const uint64_t cache_key = this->cache_key( gdi_ctx );
+
+			if ( this->load_cache( cache_key ) )
+			{
+				SelectObject( gdi_ctx, prev_gdi_font );
+				DeleteObject( gdi_font );
+				DeleteDC( gdi_ctx );
+
+				return true;
+			}
+
+			this->m_width = this->m_height = 128;
+
+			while ( this->paint_or_measure_alphabet( gdi_ctx, true ) == 2 )
+			{
+				this->m_width *= 2;
+				this->m_height *= 2;
+			}
+
+			// D3D11 doesn't have device caps in the same way, use reasonable max
+			const uint32_t max_texture_size = 16384;
+
+			if ( this->m_width > max_texture_size )
+			{
+				this->m_scale = static_cast< float >( max_texture_size ) / this->m_width;
+				this->m_width = this->m_height = max_texture_size;
+
+				bool first_iteration = true;
+
+				do
+				{
+					if ( !first_iteration )
+						this->m_scale *= 0.9f;
+
+					DeleteObject( SelectObject( gdi_ctx, prev_gdi_font ) );
+					this->create_gdi_font( gdi_ctx, &gdi_font );
+					prev_gdi_font = SelectObject( gdi_ctx, gdi_font );
+					first_iteration = false;
+				} while ( this->paint_or_measure_alphabet( gdi_ctx, true ) == 2 );
+			}
+
+			DWORD* bitmap_bits = nullptr;
+
+			BITMAPINFO bitmap_ctx {};
+			bitmap_ctx.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+			bitmap_ctx.bmiHeader.biWidth = this->m_width;
+			bitmap_ctx.bmiHeader.biHeight = -static_cast< int32_t >( this->m_height );
+			bitmap_ctx.bmiHeader.biPlanes = 1;
+			bitmap_ctx.bmiHeader.biCompression = BI_RGB;
+			bitmap_ctx.bmiHeader.biBitCount = 32;
+
+			bitmap = CreateDIBSection( gdi_ctx, &bitmap_ctx, DIB_RGB_COLORS, reinterpret_cast< void** >( &bitmap_bits ), nullptr, 0 );
+			if ( !bitmap || !bitmap_bits )
+				return false;
+
+			prev_bitmap = SelectObject( gdi_ctx, bitmap );
+
+			SetTextColor( gdi_ctx, RGB( 255, 255, 255 ) );
+			SetBkColor( gdi_ctx, 0x00000000 );
+			SetBkMode( gdi_ctx, OPAQUE );
+			SetTextAlign( gdi_ctx, TA_TOP );
+
+			// glyph 0 is the null glyph, it still advances like the old zero-sized coords did
+			memset( this->m_dense_ids, 0, sizeof( this->m_dense_ids ) );
+			this->m_sparse_ids.clear( );
+			this->m_glyphs.assign( 1, daisy_glyph_t { { }, { 0.f, 0.f }, 1.f - 2.f * this->m_spacing } );
+
+			if ( this->paint_or_measure_alphabet( gdi_ctx, false ) )
+				return false;
+
+			stl::sort( this->m_sparse_ids.begin( ), this->m_sparse_ids.end( ) );
+
+			if ( !this->create_glyph_buffer( static_cast< uint32_t >( this->m_glyphs.size( ) ) ) )
+				return false;
+
+			// Convert into m_upload, the texture is created immutable from it
+			const uint32_t texel_size = this->texel_size( );
+			this->m_upload.resize( ( static_cast< size_t >( this->m_width ) * this->m_height * texel_size + 3 ) / sizeof( uint32_t ) );
+
+			uint8_t* dst = reinterpret_cast< uint8_t* >( this->m_upload.data( ) );
+
+			// Write RGBA data
+			// GDI renders white text_w on black background
+			// We store white RGB (255,255,255) with luminance as alpha, FONT_A8 keeps only the alpha
+			for ( uint32_t y = 0; y < this->m_height; y++ )
+			{
+				for ( uint32_t x = 0; x < this->m_width; x++ )
+				{
+					// GDI bitmap format is BGRA (B at byte 0, G at 1, R at 2, A at 3)
+					DWORD pixel = bitmap_bits[ this->m_width * y + x ];
+
+					// Extract color components
+					BYTE b = ( pixel >> 0 ) & 0xFF;
+					BYTE g = ( pixel >> 8 ) & 0xFF;
+					BYTE r = ( pixel >> 16 ) & 0xFF;
+
+					// Calculate luminance - max of RGB channels for white text_w
+					BYTE intensity = max( max( r, g ), b );
+
+					if ( texel_size == 1 )
+					{
+						*dst++ = intensity;
+						continue;
+					}
+
+					// Write R8G8B8A8: R, G, B, A in memory order
+					dst[ 0 ] = 255;      // R - full white
+					dst[ 1 ] = 255;      // G - full white  
+					dst[ 2 ] = 255;      // B - full white
+					dst[ 3 ] = intensity; // A - text_w opacity (0=transparent, 255=solid)
+
+					dst += 4;
+				}
+			}
+
+			this->finish_texels( reinterpret_cast< uint8_t* >( this->m_upload.data( ) ), this->m_width, this->m_height );
+
+			// Create D3D11 texture
+			if ( !this->create_texture( this->m_upload.data( ) ) )
+				return false;
+
+			if ( !daisy_t::s_font_cache_directory.empty( ) )
+				this->save_cache( cache_key, this->m_upload.data( ) );
+
+			stl::vector<uint32_t>( ).swap( this->m_upload );
+
+			SelectObject( gdi_ctx, prev_bitmap );
+			SelectObject( gdi_ctx, prev_gdi_font );
+			DeleteObject( bitmap );
+			DeleteObject( gdi_font );
+			DeleteDC( gdi_ctx );
+
+			return true;
+		}
+
+		void create_gdi_font( HDC context, HGDIOBJ* gdi_font ) noexcept
+		{
+			*gdi_font = CreateFontA( this->m_size, 0, 0, 0, ( this->m_flags & FONT_BOLD ) ? FW_BOLD : FW_NORMAL,
+				( this->m_flags & FONT_ITALIC ) ? TRUE : FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+				OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, this->m_quality, VARIABLE_PITCH, this->m_family.data( ) );
+		}
+
+		int paint_or_measure_alphabet( HDC context, bool measure = false ) noexcept
+		{
+			SIZE size;
+			wchar_t chr[ ] = L"x\0\0";
+
+			if ( !GetTextExtentPoint32W( context, chr, 1, &size ) )
+				return 1;
+
+			const auto unicode_ranges_size = GetFontUnicodeRanges( context, nullptr );
+			if ( !unicode_ranges_size )
+				return 1;
+
+			auto glyph_sets_memory = stl::make_unique<uint8_t[ ]>( unicode_ranges_size );
+			if ( !glyph_sets_memory )
+				return 1;
+
+			auto glyph_sets = reinterpret_cast< GLYPHSET* >( glyph_sets_memory.get( ) );
+
+			if ( !GetFontUnicodeRanges( context, glyph_sets ) )
+				return 1;
+
+			this->m_spacing = this->glyph_spacing( size.cy );
+
+			uint32_t x = this->m_spacing;
+			uint32_t y = this->glyph_margin( );
+
+			for ( uint32_t r = 0; r < glyph_sets->cRanges; ++r )
+			{
+				for ( auto ch = glyph_sets->ranges[ r ].wcLow; ch < ( glyph_sets->ranges[ r ].wcLow + glyph_sets->ranges[ r ].cGlyphs ); ++ch )
+				{
+					if ( !GetTextExtentPoint32W( context, &ch, 1, &size ) )
+						continue;
+
+					if ( x + size.cx + this->m_spacing > this->m_width )
+					{
+						x = this->m_spacing;
+						y += size.cy + this->row_gap( );
+					}
+
+					if ( y + size.cy + this->glyph_margin( ) > this->m_height )
+						return 2;
+
+					if ( !measure )
+					{
+						if ( !ExtTextOutW( context, x + 0, y + 0, ETO_OPAQUE, nullptr, &ch, 1, nullptr ) )
+							return 1;
+
+						daisy_glyph_t glyph {};
+						glyph.m_uv[ 0 ] = ( static_cast< float >( x + 0 - this->m_spacing ) ) / this->m_width;
+						glyph.m_uv[ 1 ] = ( static_cast< float >( y + 0 + 0 ) ) / this->m_height;
+						glyph.m_uv[ 2 ] = ( static_cast< float >( x + size.cx + this->m_spacing ) ) / this->m_width;
+						glyph.m_uv[ 3 ] = ( static_cast< float >( y + size.cy + 0 ) ) / this->m_height;
+						glyph.m_size[ 0 ] = ( glyph.m_uv[ 2 ] - glyph.m_uv[ 0 ] ) * this->m_width / this->m_scale;
+						glyph.m_size[ 1 ] = ( glyph.m_uv[ 3 ] - glyph.m_uv[ 1 ] ) * this->m_height / this->m_scale;
+						glyph.m_advance = glyph.m_size[ 0 ] - 2.f * this->m_spacing + 1.f;
+
+						const uint32_t id = static_cast< uint32_t >( this->m_glyphs.size( ) );
+						const uint32_t code = static_cast< uint16_t >( ch );
+
+						if ( code < dense_glyph_range )
+							this->m_dense_ids[ code ] = id;
+						else
+							this->m_sparse_ids.emplace_back( code, id );
+
+						this->m_glyphs.push_back( glyph );
+					}
+
+					x += size.cx + ( 2 * this->m_spacing );
+				}
+			}
+
+			return 0;
+		}
+
+	public:
+		c_fontwrapper( ) noexcept
+			: m_dense_ids { }, m_family( ), m_scale( 0.f ), m_width( 0 ), m_height( 0 ), m_spacing( 0 ), m_size( 0 ), m_quality( NONANTIALIASED_QUALITY ), m_flags( 0 ),
+			m_ascii_advances { }
+		{
+		}
+
+		~c_fontwrapper( )
+		{
+			erase( );
+		}
+
+		c_fontwrapper( const c_fontwrapper& ) = delete;
+		c_fontwrapper& operator=( const c_fontwrapper& ) = delete;
+
+		[[nodiscard]] bool create( const stl::string_view family, uint32_t height, uint32_t quality, uint8_t flags ) noexcept
+		{
+			this->m_family = family;
+			this->m_size = height;
+			this->m_flags = flags;
+			this->m_quality = quality;
+			this->m_scale = 1.f;
+			this->m_spacing = 0;
+
+			this->release_resources( );
+			this->release_gdi( );
+
+			const bool created = this->create_ex( );
+			this->build_advances( );
+
+			return created;
+		}
+
+		template <typename t = stl::string_view>
+		point_t text_extent( t text ) noexcept
+		{
+			if ( this->m_measure_memo_capacity )
+				return this->memoized( text ).m_extent;
+
+			return this->measure_lines( text, nullptr );
+		}
+
+		// Measures count strings in one call, see daisy_text_measure_t; result keeps its capacity between calls
+		template <typename t = stl::string_view>
+		void measure( const t* texts, size_t count, daisy_text_measure_t& result ) noexcept
+		{
+			result.m_extents.resize( count );
+			result.m_line_widths.clear( );
+			result.m_first_line.resize( count + 1 );
+
+			for ( size_t i = 0; i < count; i++ )
+			{
+				result.m_first_line[ i ] = static_cast< uint32_t >( result.m_line_widths.size( ) );
+
+				if ( this->m_measure_memo_capacity )
+				{
+					const auto& memo = this->memoized( texts[ i ] );
+					result.m_extents[ i ] = memo.m_extent;
+					result.m_line_widths.insert( result.m_line_widths.end( ), memo.m_line_widths.begin( ), memo.m_line_widths.end( ) );
+				}
+				else
+					result.m_extents[ i ] = this->measure_lines( texts[ i ], &result.m_line_widths );
+			}
+
+			result.m_first_line[ count ] = static_cast< uint32_t >( result.m_line_widths.size( ) );
+		}
+
+		// Remembers the measurements of up to entries strings (keyed by their code units) for text_extent,
+		// measure and push_text alignment; a full memo is emptied. 0 turns it off
+		// - the memo is written while measuring, so a font with one must not be measured from several threads at once
+		void set_measure_cache( uint32_t entries ) noexcept
+		{
+			this->m_measure_memo_capacity = entries;
+			this->m_measure_memo.clear( );
+		}
+
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			if ( !pre_reset )
+			{
+				const bool created = this->create_ex( );
+				this->build_advances( );
+
+				return created;
+			}
+			else
+				this->release_resources( );
+
+			return true;
+		}
+
+		// Uploads what a FONT_LAZY font rasterized since the last call: the dirty rectangle of each page and the
+		// new glyph table entries. c_renderqueue::flush does this for every lazy font
+		// - only one thread at a time may record a lazy font, flush may run on another one meanwhile
+		bool update( ) noexcept
+		{
+			stl::lock_guard<stl::mutex> lock( this->m_lazy_lock );
+			return this->upload_glyphs( );
+		}
+
+		void erase( ) noexcept
+		{
+			this->release_resources( );
+			this->release_gdi( );
+
+			memset( this->m_dense_ids, 0, sizeof( this->m_dense_ids ) );
+			this->m_sparse_ids.clear( );
+			this->m_glyphs.clear( );
+			this->m_size = this->m_spacing = this->m_flags = 0;
+			this->m_scale = 1.f;
+			this->m_family = "";
+
+			this->build_advances( );
+		}
+
+		// Getters
+		// - never rasterizes, a glyph a lazy font hasn't met yet has the null glyph's uvs
+		template <typename t = char>
+		const uv_t& coords( t glyph ) const noexcept
+		{
+			uint32_t id;
+			return this->glyph( this->find_glyph( code_point( glyph ), id ) ? id : 0 ).m_uv;
+		}
+
+		// Index into the glyph table, 0 for glyphs the font does not have; lazy fonts rasterize the glyph the
+		// first time, which is why this and everything measuring text isn't const
+		template <typename t = char>
+		uint32_t glyph_id( t glyph ) noexcept
+		{
+			const uint32_t code = code_point( glyph );
+
+			uint32_t id;
+			return this->find_glyph( code, id ) ? id : this->rasterize_glyph( code );
+		}
+
+		// Texture page a glyph lives on, always 0 unless the font is FONT_LAZY
+		uint32_t glyph_page( uint32_t id ) const noexcept
+		{
+			return id < this->m_glyph_pages.size( ) ? this->m_glyph_pages[ id ] : 0;
+		}
+
+		ID3D11ShaderResourceView* page_srv( uint32_t page ) const noexcept
+		{
+			return page < this->m_pages.size( ) ? this->m_pages[ page ].m_texture_srv : this->m_texture_srv;
+		}
+
+		bool lazy( ) const noexcept
+		{
+			return !this->m_pages.empty( );
+		}
+
+		bool sdf( ) const noexcept
+		{
+			return this->m_flags & FONT_SDF;
+		}
+
+		// Changes when the font is recreated, reset or erased, so anything holding on to its texture views or
+		// uvs (the text run cache) can tell they went stale; never shared with another font, not even one
+		// later constructed at the same address
+		uint32_t generation( ) const noexcept
+		{
+			return this->m_generation;
+		}
+
+		// Height the font was created with, push_text scales SDF fonts relative to it
+		uint32_t size( ) const noexcept
+		{
+			return this->m_size;
+		}
+
+		DXGI_FORMAT texture_format( ) const noexcept
+		{
+			return ( this->m_flags & FONT_A8 ) ? DXGI_FORMAT_A8_UNORM : DXGI_FORMAT_B8G8R8A8_UNORM;
+		}
+
+		const daisy_glyph_t& glyph( uint32_t id ) const noexcept
+		{
+			if ( id < this->m_glyphs.size( ) )
+				return this->m_glyphs[ id ];
+
+			static daisy_glyph_t null_glyph { };
+			return null_glyph;
+		}
+
+		ID3D11ShaderResourceView* glyph_srv( ) const noexcept
+		{
+			return this->m_glyph_srv;
+		}
+
+		ID3D11Texture2D* texture( ) const noexcept
+		{
+			return this->m_texture;
+		}
+
+		uint32_t spacing( ) const noexcept
+		{
+			return this->m_spacing;
+		}
+		uint32_t width( ) const noexcept
+		{
+			return this->m_width;
+		}
+		uint32_t height( ) const noexcept
+		{
+			return this->m_height;
+		}
+		float scale( ) const noexcept
+		{
+			return this->m_scale;
+		}
+		// Atlas texels kept clear above and below every glyph cell, SDF quads grow into them for outlines and glows
+		uint32_t glyph_margin( ) const noexcept
+		{
+			return ( this->m_flags & FONT_SDF ) ? static_cast< uint32_t >( daisy_sdf_spread ) : 0;
+		}
+		ID3D11ShaderResourceView* texture_srv( ) const noexcept
+		{
+			return this->m_texture_srv;
+		}
+	};
+
+	class c_texatlas : public c_daisy_resettable_object
+	{
+	private:
+		// Skyline packer: the top edge of everything packed so far as spans sorted by x, images go wherever they
+		// end up lowest, so the space above short images is not lost like it was on shelves
+		struct skyline_t
+		{
+			uint32_t m_x, m_y, m_width;
+		};
+
+		point_t m_dimensions;
+		ID3D11Texture2D* m_texture = nullptr;
+		ID3D11ShaderResourceView* m_texture_srv = nullptr;
+		stl::vector<skyline_t> m_skyline;
+		uint64_t m_packed_area;
+
+	private:
+		// Lowest y an image of width can sit at when its left edge is on span index, ~0u if it sticks out
+		uint32_t fit( size_t index, uint32_t width, uint32_t height ) const noexcept
+		{
+			const uint32_t atlas_width = static_cast< uint32_t >( this->m_dimensions.x );
+			const uint32_t atlas_height = static_cast< uint32_t >( this->m_dimensions.y );
+
+			if ( this->m_skyline[ index ].m_x + width > atlas_width )
+				return ~0u;
+
+			uint32_t y = 0;
+
+			for ( uint32_t left = width; left; index++ )
+			{
+				y = max( y, this->m_skyline[ index ].m_y );
+				if ( y + height > atlas_height )
+					return ~0u;
+
+				left -= min( left, this->m_skyline[ index ].m_width );
+			}
+
+			return y;
+		}
+
+		// Finds room for width x height, lowest top edge first and the narrowest span on ties
+		bool pack( uint32_t width, uint32_t height, uint32_t& x, uint32_t& y ) noexcept
+		{
+			size_t best = this->m_skyline.size( );
+			uint32_t best_y = ~0u, best_width = ~0u;
+
+			for ( size_t i = 0; i < this->m_skyline.size( ); i++ )
+			{
+				const uint32_t top = this->fit( i, width, height );
+
+				if ( top < best_y || ( top == best_y && top != ~0u && this->m_skyline[ i ].m_width < best_width ) )
+				{
+					best = i;
+					best_y = top;
+					best_width = this->m_skyline[ i ].m_width;
+				}
+			}
+
+			if ( best == this->m_skyline.size( ) )
+				return false;
+
+			x = this->m_skyline[ best ].m_x;
+			y = best_y;
+
+			// the new span covers [x, x + width), shorten or drop the spans it lies on
+			this->m_skyline.insert( this->m_skyline.begin( ) + best, skyline_t { x, y + height, width } );
+
+			for ( size_t i = best + 1; i < this->m_skyline.size( ); )
+			{
+				auto& span = this->m_skyline[ i ];
+				if ( span.m_x >= x + width )
+					break;
+
+				const uint32_t covered = min( span.m_width, x + width - span.m_x );
+				span.m_x += covered;
+				span.m_width -= covered;
+
+				if ( span.m_width )
+					break;
+
+				this->m_skyline.erase( this->m_skyline.begin( ) + i );
+			}
+
+			// neighbours at the same height become one span
+			for ( size_t i = 0; i + 1 < this->m_skyline.size( ); )
+			{
+				if ( this->m_skyline[ i ].m_y == this->m_skyline[ i + 1 ].m_y )
+				{
+					this->m_skyline[ i ].m_width += this->m_skyline[ i + 1 ].m_width;
+					this->m_skyline.erase( this->m_skyline.begin( ) + i + 1 );
+				}
+				else
+					i++;
+			}
+
+			this->m_packed_area += static_cast< uint64_t >( width ) * height;
+			return true;
+		}
+
+	public:
+		stl::unordered_map<uint32_t, uv_t> m_coords;
+
+		c_texatlas( ) noexcept
+			: m_dimensions( { 0.f, 0.f } ), m_packed_area( 0 )
+		{
+		}
+
+		~c_texatlas( )
+		{
+			if ( m_texture_srv )
+			{
+				daisy_unregister_texture( m_texture_srv );
+				m_texture_srv->Release( );
+			}
+			if ( m_texture )
+				m_texture->Release( );
+		}
+
+		c_texatlas( const c_texatlas& ) = delete;
+		c_texatlas& operator=( const c_texatlas& ) = delete;
+
+		[[nodiscard]] bool create( const point_t& dimensions ) noexcept
+		{
+			if ( !daisy_t::s_device )
+				return false;
+
+			this->m_dimensions = dimensions;
+			this->m_skyline.assign( 1, skyline_t { 0, 0, static_cast< uint32_t >( dimensions.x ) } );
+			this->m_packed_area = 0;
+
+			// appends upload just their rectangle with UpdateSubresource
+			D3D11_TEXTURE2D_DESC tex_desc = {};
+			tex_desc.Width = static_cast< UINT >( dimensions.x );
+			tex_desc.Height = static_cast< UINT >( dimensions.y );
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.Usage = D3D11_USAGE_DEFAULT;
+			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+			HRESULT hr = daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &this->m_texture );
+			if ( FAILED( hr ) )
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+			srv_desc.Format = tex_desc.Format;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srv_desc.Texture2D.MipLevels = 1;
+
+			hr = daisy_t::s_device->CreateShaderResourceView( this->m_texture, &srv_desc, &this->m_texture_srv );
+			if ( FAILED( hr ) )
+				return false;
+
+			return true;
+		}
+
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			if ( !pre_reset )
+				return this->create( this->m_dimensions );
+			else
+			{
+				if ( m_texture_srv )
+				{
+					daisy_unregister_texture( m_texture_srv );
+					m_texture_srv->Release( );
+					m_texture_srv = nullptr;
+				}
+				if ( m_texture )
+				{
+					m_texture->Release( );
+					m_texture = nullptr;
+				}
+			}
+			return true;
+		}
+
+		// Packs a width x height BGRA image (tex_size bytes, tightly packed rows) and uploads only its rectangle
+		bool append( const uint32_t uuid, const point_t& dimensions, uint8_t* tex_data, uint32_t tex_size ) noexcept
+		{
+			if ( !tex_data || !tex_size || !this->m_texture )
+				return false;
+
+			const uint32_t width = static_cast< uint32_t >( dimensions.x ), height = static_cast< uint32_t >( dimensions.y );
+			if ( !width || !height || static_cast< uint64_t >( width ) * height * 4 > tex_size )
+				return false;
+
+			uint32_t x, y;
+			if ( !this->pack( width, height, x, y ) )
+				return false;
+
+			const D3D11_BOX box { x, y, 0, x + width, y + height, 1 };
+			daisy_t::s_context->UpdateSubresource( this->m_texture, 0, &box, tex_data, width * 4, 0 );
+
+			this->m_coords[ uuid ] = uv_t { x / this->m_dimensions.x, y / this->m_dimensions.y,
+				( x + width ) / this->m_dimensions.x, ( y + height ) / this->m_dimensions.y };
+
+			return true;
+		}
+
+		// Packs a batch of images tallest first and uploads them through one staging texture: a single Map, then a GPU copy
+		// per image into the atlas
+		// - returns how many were packed, images that don't fit or are malformed get no coords
+		// - efficiency receives the batch's pixel area over the area of the rectangle bounding it
+		uint32_t append_batch( const daisy_atlas_image_t* images, size_t count, float* efficiency = nullptr ) noexcept
+		{
+			if ( efficiency )
+				*efficiency = 0.f;
+
+			if ( !images || !count || !this->m_texture )
+				return 0;
+
+			struct placed_t
+			{
+				size_t m_image;
+				uint32_t m_x, m_y, m_width, m_height;
+			};
+
+			stl::vector<placed_t> placed;
+			placed.reserve( count );
+
+			for ( size_t i = 0; i < count; i++ )
+			{
+				const uint32_t width = static_cast< uint32_t >( images[ i ].m_dimensions.x ), height = static_cast< uint32_t >( images[ i ].m_dimensions.y );
+				if ( images[ i ].m_tex_data && width && height && static_cast< uint64_t >( width ) * height * 4 <= images[ i ].m_tex_size )
+					placed.push_back( placed_t { i, 0, 0, width, height } );
+			}
+
+			// tallest first keeps the skyline flat, widest first among equals
+			stl::stable_sort( placed.begin( ), placed.end( ), [ ]( const placed_t& a, const placed_t& b ) {
+				return a.m_height != b.m_height ? a.m_height > b.m_height : a.m_width > b.m_width;
+			} );
+
+			uint32_t left = ~0u, top = ~0u, right = 0, bottom = 0;
+			uint64_t area = 0;
+
+			size_t packed = 0;
+			for ( size_t i = 0; i < placed.size( ); i++ )
+			{
+				auto image = placed[ i ];
+				if ( !this->pack( image.m_width, image.m_height, image.m_x, image.m_y ) )
+					continue;
+
+				left = min( left, image.m_x );
+				top = min( top, image.m_y );
+				right = max( right, image.m_x + image.m_width );
+				bottom = max( bottom, image.m_y + image.m_height );
+				area += static_cast< uint64_t >( image.m_width ) * image.m_height;
+				placed[ packed++ ] = image;
+			}
+			placed.resize( packed );
+
+			if ( placed.empty( ) )
+				return 0;
+
+			if ( efficiency )
+				*efficiency = static_cast< float >( static_cast< double >( area ) / ( static_cast< double >( right - left ) * ( bottom - top ) ) );
+
+			D3D11_TEXTURE2D_DESC tex_desc = {};
+			tex_desc.Width = right - left;
+			tex_desc.Height = bottom - top;
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.Usage = D3D11_USAGE_STAGING;
+			tex_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+			ID3D11Texture2D* staging = nullptr;
+			D3D11_MAPPED_SUBRESOURCE mapped;
+
+			if ( SUCCEEDED( daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &staging ) )
+				&& SUCCEEDED( daisy_t::s_context->Map( staging, 0, D3D11_MAP_WRITE, 0, &mapped ) ) )
+			{
+				for ( const auto& image : placed )
+				{
+					const uint8_t* src = images[ image.m_image ].m_tex_data;
+					uint8_t* dst = static_cast< uint8_t* >( mapped.pData ) + static_cast< size_t >( image.m_y - top ) * mapped.RowPitch + ( image.m_x - left ) * 4;
+
+					for ( uint32_t y = 0; y < image.m_height; y++ )
+						memcpy( dst + static_cast< size_t >( y ) * mapped.RowPitch, src + static_cast< size_t >( y ) * image.m_width * 4, image.m_width * 4 );
+				}
+
+				daisy_t::s_context->Unmap( staging, 0 );
+
+				// per image copies, the gaps between them may hold earlier appends
+				for ( const auto& image : placed )
+				{
+					const D3D11_BOX box { image.m_x - left, image.m_y - top, 0, image.m_x - left + image.m_width, image.m_y - top + image.m_height, 1 };
+					daisy_t::s_context->CopySubresourceRegion( this->m_texture, 0, image.m_x, image.m_y, 0, staging, 0, &box );
+				}
+			}
+			else
+			{
+				for ( const auto& image : placed )
+				{
+					const D3D11_BOX box { image.m_x, image.m_y, 0, image.m_x + image.m_width, image.m_y + image.m_height, 1 };
+					daisy_t::s_context->UpdateSubresource( this->m_texture, 0, &box, images[ image.m_image ].m_tex_data, image.m_width * 4, 0 );
+				}
+			}
+
+			if ( staging )
+				staging->Release( );
+
+			for ( const auto& image : placed )
+			{
+				this->m_coords[ images[ image.m_image ].m_uuid ] = uv_t { image.m_x / this->m_dimensions.x, image.m_y / this->m_dimensions.y,
+					( image.m_x + image.m_width ) / this->m_dimensions.x, ( image.m_y + image.m_height ) / this->m_dimensions.y };
+			}
+
+			return static_cast< uint32_t >( placed.size( ) );
+		}
+
+		const uv_t& coords( uint32_t uuid ) const noexcept
+		{
+			if ( this->m_coords.find( uuid ) != this->m_coords.end( ) )
+				return this->m_coords.at( uuid );
+
+			static uv_t null_uv { 0.f, 0.f, 0.f, 0.f };
+			return null_uv;
+		}
+
+		ID3D11ShaderResourceView* texture_srv( ) const noexcept
+		{
+			return this->m_texture_srv;
+		}
+
+		ID3D11Texture2D* texture( ) const noexcept
+		{
+			return this->m_texture;
+		}
+
+		const point_t& dimensions( ) const noexcept
+		{
+			return this->m_dimensions;
+		}
+
+		// Share of the atlas covered by packed images
+		float occupancy( ) const noexcept
+		{
+			const double area = static_cast< double >( this->m_dimensions.x ) * this->m_dimensions.y;
+			return area > 0.0 ? static_cast< float >( this->m_packed_area / area ) : 0.f;
+		}
+	};
+
+	// Image handed out by c_imagecache::find, valid until the entry is replaced, evicted or moved by a defragment
+	struct daisy_image_t
+	{
+		ID3D11ShaderResourceView* m_texture_srv;
+		uv_t m_uv;
+	};
+
+	// Dynamic image cache - atlas pages whose entries can be replaced and removed, for images that come and go
+	// - at most max_pages pages of page_dimensions each, created as they are needed, so VRAM stays at a fixed budget
+	// - every page keeps a list of free rectangles (guillotine split, best area fit), freed rectangles merge with
+	//   their neighbours and are reused
+	// - when nothing fits the least recently used images are evicted, except those used since next_frame( )
+	// - inserts upload only the image's rectangle with UpdateSubresource
+	class c_imagecache : public c_daisy_resettable_object
+	{
+	public:
+		struct stats_t
+		{
+			uint64_t m_hits { 0 }, m_misses { 0 }, m_evictions { 0 }, m_uploads { 0 }, m_defragments { 0 };
+		};
+
+	private:
+		static constexpr uint32_t none = ~0u;
+
+		struct rect_t
+		{
+			uint32_t m_x, m_y, m_width, m_height;
+		};
+
+		struct page_t
+		{
+			ID3D11Texture2D* m_texture;
+			ID3D11ShaderResourceView* m_texture_srv;
+			stl::vector<rect_t> m_free;
+			uint64_t m_used_area;
+		};
+
+		struct entry_t
+		{
+			uint32_t m_uuid, m_page;
+			rect_t m_rect;
+			uint64_t m_frame;
+			uint32_t m_prev, m_next;
+		};
+
+		point_t m_dimensions;
+		uint32_t m_max_pages;
+		stl::vector<page_t> m_pages;
+		stl::vector<entry_t> m_entries;
+		stl::vector<uint32_t> m_free_entries;
+		stl::unordered_map<uint32_t, uint32_t> m_lookup;
+		uint32_t m_head = none, m_tail = none;
+		uint64_t m_frame;
+		bool m_defragment;
+		ID3D11Texture2D* m_scratch = nullptr;
+		stats_t m_stats;
+
+	private:
+		void unlink( entry_t& entry ) noexcept
+		{
+			( entry.m_prev != none ? this->m_entries[ entry.m_prev ].m_next : this->m_head ) = entry.m_next;
+			( entry.m_next != none ? this->m_entries[ entry.m_next ].m_prev : this->m_tail ) = entry.m_prev;
+		}
+
+		void link_front( entry_t& entry, uint32_t index ) noexcept
+		{
+			entry.m_prev = none;
+			entry.m_next = this->m_head;
+
+			if ( this->m_head != none )
+				this->m_entries[ this->m_head ].m_prev = index;
+			else
+				this->m_tail = index;
+
+			this->m_head = index;
+		}
+
+		D3D11_TEXTURE2D_DESC page_desc( ) const noexcept
+		{
+			D3D11_TEXTURE2D_DESC tex_desc = {};
+			tex_desc.Width = static_cast< UINT >( this->m_dimensions.x );
+			tex_desc.Height = static_cast< UINT >( this->m_dimensions.y );
+			tex_desc.MipLevels = 1;
+			tex_desc.ArraySize = 1;
+			tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+			tex_desc.SampleDesc.Count = 1;
+			tex_desc.Usage = D3D11_USAGE_DEFAULT;
+			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			return tex_desc;
+		}
+
+		bool add_page( ) noexcept
+		{
+			if ( !daisy_t::s_device || this->m_pages.size( ) >= this->m_max_pages )
+				return false;
+
+			const D3D11_TEXTURE2D_DESC tex_desc = this->page_desc( );
+
+			page_t page { nullptr, nullptr, { }, 0 };
+			HRESULT hr = daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &page.m_texture );
+			if ( FAILED( hr ) )
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+			srv_desc.Format = tex_desc.Format;
+			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srv_desc.Texture2D.MipLevels = 1;
+
+			hr = daisy_t::s_device->CreateShaderResourceView( page.m_texture, &srv_desc, &page.m_texture_srv );
+			if ( FAILED( hr ) )
+			{
+				page.m_texture->Release( );
+				return false;
+			}
+
+			page.m_free.push_back( rect_t { 0, 0, tex_desc.Width, tex_desc.Height } );
+			this->m_pages.push_back( stl::move( page ) );
+			return true;
+		}
+
+		void release_pages( ) noexcept
+		{
+			for ( auto& page : this->m_pages )
+			{
+				if ( page.m_texture_srv )
+				{
+					daisy_unregister_texture( page.m_texture_srv );
+					page.m_texture_srv->Release( );
+				}
+				if ( page.m_texture )
+					page.m_texture->Release( );
+			}
+			this->m_pages.clear( );
+
+			if ( this->m_scratch )
+			{
+				this->m_scratch->Release( );
+				this->m_scratch = nullptr;
+			}
+		}
+
+		// Carves width x height out of the free rectangle that leaves the least area over, splitting the rest
+		// along the shorter leftover side so the bigger piece stays whole
+		static bool allocate( stl::vector<rect_t>& free_rects, uint32_t width, uint32_t height, rect_t& result ) noexcept
+		{
+			size_t best = free_rects.size( );
+			uint64_t best_area = ~0ull;
+			uint32_t best_side = ~0u;
+
+			for ( size_t i = 0; i < free_rects.size( ); i++ )
+			{
+				const auto& rect = free_rects[ i ];
+				if ( rect.m_width < width || rect.m_height < height )
+					continue;
+
+				const uint64_t area = static_cast< uint64_t >( rect.m_width ) * rect.m_height;
+				const uint32_t side = min( rect.m_width - width, rect.m_height - height );
+
+				if ( area < best_area || ( area == best_area && side < best_side ) )
+				{
+					best = i;
+					best_area = area;
+					best_side = side;
+				}
+			}
+
+			if ( best == free_rects.size( ) )
+				return false;
+
+			const rect_t rect = free_rects[ best ];
+			free_rects.erase( free_rects.begin( ) + best );
+
+			result = rect_t { rect.m_x, rect.m_y, width, height };
+
+			const uint32_t right = rect.m_width - width, below = rect.m_height - height;
+			rect_t side_rect, bottom_rect;
+
+			if ( right < below )
+			{
+				side_rect = rect_t { rect.m_x + width, rect.m_y, right, height };
+				bottom_rect = rect_t { rect.m_x, rect.m_y + height, rect.m_width, below };
+			}
+			else
+			{
+				side_rect = rect_t { rect.m_x + width, rect.m_y, right, rect.m_height };
+				bottom_rect = rect_t { rect.m_x, rect.m_y + height, width, below };
+			}
+
+			if ( side_rect.m_width && side_rect.m_height )
+				free_rects.push_back( side_rect );
+			if ( bottom_rect.m_width && bottom_rect.m_height )
+				free_rects.push_back( bottom_rect );
+
+			return true;
+		}
+
+		// Returns rect to the free list and merges free rectangles that share a whole edge
+		static void release( stl::vector<rect_t>& free_rects, const rect_t& rect ) noexcept
+		{
+			free_rects.push_back( rect );
+
+			for ( bool merged = true; merged; )
+			{
+				merged = false;
+
+				for ( size_t i = 0; i < free_rects.size( ) && !merged; i++ )
+				{
+					for ( size_t j = i + 1; j < free_rects.size( ); j++ )
+					{
+						auto& a = free_rects[ i ];
+						const auto& b = free_rects[ j ];
+
+						if ( a.m_x == b.m_x && a.m_width == b.m_width && ( a.m_y + a.m_height == b.m_y || b.m_y + b.m_height == a.m_y ) )
+						{
+							a.m_y = min( a.m_y, b.m_y );
+							a.m_height += b.m_height;
+						}
+						else if ( a.m_y == b.m_y && a.m_height == b.m_height && ( a.m_x + a.m_width == b.m_x || b.m_x + b.m_width == a.m_x ) )
+						{
+							a.m_x = min( a.m_x, b.m_x );
+							a.m_width += b.m_width;
+						}
+						else
+							continue;
+
+						free_rects.erase( free_rects.begin( ) + j );
+						merged = true;
+						break;
+					}
+				}
+			}
+		}
+
+		void remove( uint32_t index ) noexcept
+		{
+			auto& entry = this->m_entries[ index ];
+			auto& page = this->m_pages[ entry.m_page ];
+
+			release( page.m_free, entry.m_rect );
+			page.m_used_area -= static_cast< uint64_t >( entry.m_rect.m_width ) * entry.m_rect.m_height;
+
+			this->unlink( entry );
+			this->m_lookup.erase( entry.m_uuid );
+			this->m_free_entries.push_back( index );
+		}
+
+		// Finds a page and rectangle for width x height: existing pages, then a new page, then LRU eviction
+		bool place( uint32_t width, uint32_t height, uint32_t& page, rect_t& rect ) noexcept
+		{
+			for ( page = 0; page < this->m_pages.size( ); page++ )
+			{
+				if ( allocate( this->m_pages[ page ].m_free, width, height, rect ) )
+					return true;
+			}
+
+			if ( this->add_page( ) )
+			{
+				page = static_cast< uint32_t >( this->m_pages.size( ) - 1 );
+				return allocate( this->m_pages[ page ].m_free, width, height, rect );
+			}
+
+			// images drawn this frame may still be referenced by a queue, stop at the first of them
+			while ( this->m_tail != none && this->m_entries[ this->m_tail ].m_frame != this->m_frame )
+			{
+				page = this->m_entries[ this->m_tail ].m_page;
+				this->remove( this->m_tail );
+				this->m_stats.m_evictions++;
+
+				if ( allocate( this->m_pages[ page ].m_free, width, height, rect ) )
+					return true;
+			}
+
+			return false;
+		}
+
+		uv_t coords( const entry_t& entry ) const noexcept
+		{
+			return uv_t { entry.m_rect.m_x / this->m_dimensions.x, entry.m_rect.m_y / this->m_dimensions.y,
+				( entry.m_rect.m_x + entry.m_rect.m_width ) / this->m_dimensions.x, ( entry.m_rect.m_y + entry.m_rect.m_height ) / this->m_dimensions.y };
+		}
+
+		// Largest free rectangle under half the free area while at least a quarter of the page is free
+		bool fragmented( const stl::vector<rect_t>& free_rects, uint64_t used_area ) const noexcept
+		{
+			const uint64_t page_area = static_cast< uint64_t >( this->m_dimensions.x ) * static_cast< uint64_t >( this->m_dimensions.y );
+			const uint64_t free_area = page_area - used_area;
+
+			if ( free_rects.size( ) < 2 || free_area * 4 < page_area )
+				return false;
+
+			uint64_t largest = 0;
+			for ( const auto& rect : free_rects )
+				largest = max( largest, static_cast< uint64_t >( rect.m_width ) * rect.m_height );
+
+			return largest * 2 < free_area;
+		}
+
+		// Repacks the entries of one page tallest first and moves their texels through the scratch texture
+		bool defragment( uint32_t page_index ) noexcept
+		{
+			auto& page = this->m_pages[ page_index ];
+
+			stl::vector<uint32_t> order;
+			for ( uint32_t i = this->m_head; i != none; i = this->m_entries[ i ].m_next )
+			{
+				if ( this->m_entries[ i ].m_page == page_index )
+					order.push_back( i );
+			}
+
+			stl::sort( order.begin( ), order.end( ), [ this ]( uint32_t a, uint32_t b ) {
+				const auto& ra = this->m_entries[ a ].m_rect;
+				const auto& rb = this->m_entries[ b ].m_rect;
+				return ra.m_height != rb.m_height ? ra.m_height > rb.m_height : ra.m_width > rb.m_width;
+			} );
+
+			stl::vector<rect_t> free_rects { rect_t { 0, 0, static_cast< uint32_t >( this->m_dimensions.x ), static_cast< uint32_t >( this->m_dimensions.y ) } };
+			stl::vector<rect_t> moved( order.size( ) );
+
+			for ( size_t i = 0; i < order.size( ); i++ )
+			{
+				const auto& rect = this->m_entries[ order[ i ] ].m_rect;
+				if ( !allocate( free_rects, rect.m_width, rect.m_height, moved[ i ] ) )
+					return false;
+			}
+
+			// a repack that wouldn't help isn't worth the copies
+			if ( this->fragmented( free_rects, page.m_used_area ) )
+				return false;
+
+			if ( !this->m_scratch )
+			{
+				const D3D11_TEXTURE2D_DESC tex_desc = this->page_desc( );
+				if ( FAILED( daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &this->m_scratch ) ) )
+					return false;
+			}
+
+			daisy_t::s_context->CopyResource( this->m_scratch, page.m_texture );
+
+			for ( size_t i = 0; i < order.size( ); i++ )
+			{
+				auto& rect = this->m_entries[ order[ i ] ].m_rect;
+
+				const D3D11_BOX box { rect.m_x, rect.m_y, 0, rect.m_x + rect.m_width, rect.m_y + rect.m_height, 1 };
+				daisy_t::s_context->CopySubresourceRegion( page.m_texture, 0, moved[ i ].m_x, moved[ i ].m_y, 0, this->m_scratch, 0, &box );
+
+				rect = moved[ i ];
+			}
+
+			page.m_free = stl::move( free_rects );
+			this->m_stats.m_defragments++;
+			return true;
+		}
+
+	public:
+		c_imagecache( ) noexcept
+			: m_dimensions( { 0.f, 0.f } ), m_max_pages( 0 ), m_frame( 0 ), m_defragment( false )
+		{
+		}
+
+		~c_imagecache( )
+		{
+			this->release_pages( );
+		}
+
+		c_imagecache( const c_imagecache& ) = delete;
+		c_imagecache& operator=( const c_imagecache& ) = delete;
+
+		// Pages are created on demand, the first one right away
+		[[nodiscard]] bool create( const point_t& page_dimensions, uint32_t max_pages ) noexcept
+		{
+			if ( !daisy_t::s_device || !max_pages )
+				return false;
+
+			this->clear( );
+			this->release_pages( );
+
+			this->m_dimensions = page_dimensions;
+			this->m_max_pages = max_pages;
+
+			return this->add_page( );
+		}
+
+		// Device resets lose the pages, every image misses afterwards and has to be inserted again
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			if ( !pre_reset )
+				return this->create( this->m_dimensions, this->m_max_pages );
+
+			// no entry may outlive its page, find/insert run between pre and post reset too
+			this->clear( );
+			this->release_pages( );
+			return true;
+		}
+
+		// Starts a frame: images found or inserted from here on are safe from eviction until the next call
+		// - with defragmenting on, one fragmented page is repacked on the GPU; call it before recording,
+		//   once the previous frame's queues have been flushed, since images move
+		void next_frame( ) noexcept
+		{
+			this->m_frame++;
+
+			if ( !this->m_defragment )
+				return;
+
+			for ( uint32_t i = 0; i < this->m_pages.size( ); i++ )
+			{
+				if ( this->fragmented( this->m_pages[ i ].m_free, this->m_pages[ i ].m_used_area ) && this->defragment( i ) )
+					break;
+			}
+		}
+
+		void set_defragment( bool defragment ) noexcept
+		{
+			this->m_defragment = defragment;
+		}
+
+		// The image for uuid, marked as used this frame
+		bool find( uint32_t uuid, daisy_image_t& image ) noexcept
+		{
+			const auto it = this->m_lookup.find( uuid );
+			if ( it == this->m_lookup.end( ) )
+			{
+				this->m_stats.m_misses++;
+				return false;
+			}
+
+			auto& entry = this->m_entries[ it->second ];
+			entry.m_frame = this->m_frame;
+
+			if ( this->m_head != it->second )
+			{
+				this->unlink( entry );
+				this->link_front( entry, it->second );
+			}
+
+			image.m_texture_srv = this->m_pages[ entry.m_page ].m_texture_srv;
+			image.m_uv = this->coords( entry );
+
+			this->m_stats.m_hits++;
+			return true;
+		}
+
+		// Adds or replaces the width x height BGRA image (tex_size bytes, tightly packed rows) for uuid
+		// - an image of the same size is overwritten in place
+		// - fails when it doesn't fit even after evicting every image not used this frame, uuid has no image then
+		bool insert( const uint32_t uuid, const point_t& dimensions, const uint8_t* tex_data, uint32_t tex_size ) noexcept
+		{
+			if ( !tex_data || this->m_pages.empty( ) )
+				return false;
+
+			const uint32_t width = static_cast< uint32_t >( dimensions.x ), height = static_cast< uint32_t >( dimensions.y );
+			if ( !width || !height || width > this->m_dimensions.x || height > this->m_dimensions.y || static_cast< uint64_t >( width ) * height * 4 > tex_size )
+				return false;
+
+			uint32_t index;
+
+			const auto it = this->m_lookup.find( uuid );
+			if ( it != this->m_lookup.end( ) && this->m_entries[ it->second ].m_rect.m_width == width && this->m_entries[ it->second ].m_rect.m_height == height )
+			{
+				index = it->second;
+				this->unlink( this->m_entries[ index ] );
+			}
+			else
+			{
+				if ( it != this->m_lookup.end( ) )
+					this->remove( it->second );
+
+				uint32_t page;
+				rect_t rect;
+				if ( !this->place( width, height, page, rect ) )
+					return false;
+
+				if ( !this->m_free_entries.empty( ) )
+				{
+					index = this->m_free_entries.back( );
+					this->m_free_entries.pop_back( );
+				}
+				else
+				{
+					index = static_cast< uint32_t >( this->m_entries.size( ) );
+					this->m_entries.emplace_back( );
+				}
+
+				this->m_entries[ index ].m_uuid = uuid;
+				this->m_entries[ index ].m_page = page;
+				this->m_entries[ index ].m_rect = rect;
+				this->m_pages[ page ].m_used_area += static_cast< uint64_t >( width ) * height;
+				this->m_lookup[ uuid ] = index;
+			}
+
+			auto& entry = this->m_entries[ index ];
+			entry.m_frame = this->m_frame;
+			this->link_front( entry, index );
+
+			const D3D11_BOX box { entry.m_rect.m_x, entry.m_rect.m_y, 0, entry.m_rect.m_x + width, entry.m_rect.m_y + height, 1 };
+			daisy_t::s_context->UpdateSubresource( this->m_pages[ entry.m_page ].m_texture, 0, &box, tex_data, width * 4, 0 );
+
+			this->m_stats.m_uploads++;
+			return true;
+		}
+
+		// Drops the image for uuid, its rectangle is free for the next insert
+		bool erase( uint32_t uuid ) noexcept
+		{
+			const auto it = this->m_lookup.find( uuid );
+			if ( it == this->m_lookup.end( ) )
+				return false;
+
+			this->remove( it->second );
+			return true;
+		}
+
+		bool contains( uint32_t uuid ) const noexcept
+		{
+			return this->m_lookup.find( uuid ) != this->m_lookup.end( );
+		}
+
+		// Drops every image, pages stay allocated
+		void clear( ) noexcept
+		{
+			this->m_entries.clear( );
+			this->m_free_entries.clear( );
+			this->m_lookup.clear( );
+			this->m_head = this->m_tail = none;
+
+			for ( auto& page : this->m_pages )
+			{
+				page.m_free.assign( 1, rect_t { 0, 0, static_cast< uint32_t >( this->m_dimensions.x ), static_cast< uint32_t >( this->m_dimensions.y ) } );
+				page.m_used_area = 0;
+			}
+		}
+
+		size_t size( ) const noexcept
+		{
+			return this->m_lookup.size( );
+		}
+
+		size_t pages( ) const noexcept
+		{
+			return this->m_pages.size( );
+		}
+
+		ID3D11ShaderResourceView* texture_srv( uint32_t page ) const noexcept
+		{
+			return page < this->m_pages.size( ) ? this->m_pages[ page ].m_texture_srv : nullptr;
+		}
+
+		const point_t& dimensions( ) const noexcept
+		{
+			return this->m_dimensions;
+		}
+
+		// Share of the created pages covered by images
+		float occupancy( ) const noexcept
+		{
+			uint64_t used = 0;
+			for ( const auto& page : this->m_pages )
+				used += page.m_used_area;
+
+			const double area = static_cast< double >( this->m_dimensions.x ) * this->m_dimensions.y * this->m_pages.size( );
+			return area > 0.0 ? static_cast< float >( used / area ) : 0.f;
+		}
+
+		const stats_t& stats( ) const noexcept
+		{
+			return this->m_stats;
+		}
+		void reset_stats( ) noexcept
+		{
+			this->m_stats = stats_t { };
+		}
+	};
+
+	// Backend interface - lets c_renderqueue submit somewhere other than daisy_t::s_context
+	class c_daisy_backend
+	{
+	public:
+		virtual ~c_daisy_backend( ) = default;
+
+		// Called from c_renderqueue::update with the recorded vertex/index/rect instance streams
+		virtual bool upload( const renderbuffer_t& vtxs, const renderbuffer_t& idxs, const renderbuffer_t& rects, const renderbuffer_t& glyphs ) noexcept = 0;
+
+		// Called from c_renderqueue::flush for every CALL_SCISSOR/CALL_TRI/CALL_RECT/CALL_GLYPH/CALL_SHAPE drawcall, in order
+		// - shapes come out of the rect instance stream too
+		virtual void scissor( const point_t& position, const point_t& size ) noexcept = 0;
+		virtual void draw_indexed( ID3D11ShaderResourceView* texture_srv, uint32_t indices, uint32_t start_index, uint32_t base_vertex ) noexcept = 0;
+		virtual void draw_rects( ID3D11ShaderResourceView* texture_srv, uint32_t instances, uint32_t start_instance ) noexcept = 0;
+		virtual void draw_glyphs( const c_fontwrapper& font, uint32_t instances, uint32_t start_instance ) noexcept = 0;
+		virtual void draw_shapes( uint32_t instances, uint32_t start_instance ) noexcept = 0;
+	};
+
+	// CPU reference backend - rasterizes drawcalls into an in-memory BGRA image
+	// - mirrors the default pipeline: pixel-space vertex transform, point/clamp sampling,
+	//   texture alpha as a coverage mask and SRC_ALPHA/INV_SRC_ALPHA blending
+	// - textures have no CPU copy, so callers must bind_texture( ) the pixels for every srv they draw with;
+	//   null or unknown srvs sample as the white texture
+	class c_cpu_backend : public c_daisy_backend
+	{
+	public:
+		struct stats_t
+		{
+			uint64_t m_uploads { 0 }, m_upload_bytes { 0 };
+			uint64_t m_draws { 0 }, m_vertices { 0 }, m_triangles { 0 };
+			uint64_t m_pixels_tested { 0 }, m_pixels_written { 0 };
+		};
+
+	private:
+		struct texture_t
+		{
+			uint32_t m_width { 0 }, m_height { 0 };
+			stl::vector<uint32_t> m_pixels;
+		};
+
+		stl::vector<uint32_t> m_framebuffer;
+		stl::vector<daisy_vtx_t> m_vtxs;
+		stl::vector<daisy_idx_t> m_idxs;
+		stl::vector<daisy_rect_t> m_rects;
+		stl::vector<daisy_glyph_instance_t> m_glyphs;
+		stl::unordered_map<ID3D11ShaderResourceView*, texture_t> m_textures;
+		D3D11_RECT m_scissor;
+		uint32_t m_width, m_height;
+		stats_t m_stats;
+
+	private:
+		static bool is_top_left( const float ax, const float ay, const float bx, const float by ) noexcept
+		{
+			// edges are walked clockwise in screen space (y down) once triangles are normalized
+			return ( ay == by && bx > ax ) || ( by < ay );
+		}
+
+		uint8_t sample_alpha( const texture_t* texture, float u, float v ) const noexcept
+		{
+			if ( !texture )
+				return 255;
+
+			int32_t x = static_cast< int32_t >( floorf( u * texture->m_width ) );
+			int32_t y = static_cast< int32_t >( floorf( v * texture->m_height ) );
+
+			x = min( max( x, 0 ), static_cast< int32_t >( texture->m_width ) - 1 );
+			y = min( max( y, 0 ), static_cast< int32_t >( texture->m_height ) - 1 );
+
+			return static_cast< uint8_t >( texture->m_pixels[ y * texture->m_width + x ] >> 24 );
+		}
+
+		// Bilinear alpha in [0, 1], what the linear sampler returns for FONT_SDF textures
+		float sample_alpha_linear( const texture_t* texture, float u, float v ) const noexcept
+		{
+			const float fx = u * texture->m_width - 0.5f, fy = v * texture->m_height - 0.5f;
+			const float x0 = floorf( fx ), y0 = floorf( fy );
+			const float tx = fx - x0, ty = fy - y0;
+
+			const auto texel = [ texture ]( int32_t x, int32_t y ) noexcept
+			{
+				x = min( max( x, 0 ), static_cast< int32_t >( texture->m_width ) - 1 );
+				y = min( max( y, 0 ), static_cast< int32_t >( texture->m_height ) - 1 );
+				return static_cast< float >( texture->m_pixels[ y * texture->m_width + x ] >> 24 );
+			};
+
+			const int32_t x = static_cast< int32_t >( x0 ), y = static_cast< int32_t >( y0 );
+			const float top = texel( x, y ) + ( texel( x + 1, y ) - texel( x, y ) ) * tx;
+			const float bottom = texel( x, y + 1 ) + ( texel( x + 1, y + 1 ) - texel( x, y + 1 ) ) * tx;
+
+			return ( top + ( bottom - top ) * ty ) / 255.f;
+		}
+
+		// straight alpha "over", as in shaders::sdf_pixel_shader_src
+		static void over( const float top[ 4 ], const float bottom[ 4 ], float out[ 4 ] ) noexcept
+		{
+			const float a = top[ 3 ] + bottom[ 3 ] * ( 1.f - top[ 3 ] );
+
+			for ( int c = 0; c < 3; ++c )
+				out[ c ] = ( top[ c ] * top[ 3 ] + bottom[ c ] * bottom[ 3 ] * ( 1.f - top[ 3 ] ) ) / max( a, 1e-5f );
+
+			out[ 3 ] = a;
+		}
+
+		// Mirrors shaders::sdf_pixel_shader_src: fill, outline and glow from the distance in atlas texels,
+		// w is how many texels one pixel spans
+		static void shade_sdf( float src[ 4 ], float alpha, float w, uint32_t style ) noexcept
+		{
+			const float d = ( alpha - 0.5f ) * ( 2.f * daisy_sdf_spread );
+			const auto saturate = [ ]( float f ) noexcept { return f < 0.f ? 0.f : ( f > 1.f ? 1.f : f ); };
+
+			daisy_text_style_t text_style { color_t( 0, 0, 0, 0 ), 0.f, color_t( 0, 0, 0, 0 ), 0.f };
+			if ( style < daisy_t::s_text_styles.size( ) )
+				text_style = daisy_t::s_text_styles[ style ];
+
+			const float outline = text_style.m_outline_width, glow = text_style.m_glow_width;
+			const color_t outline_color = text_style.m_outline_color, glow_color = text_style.m_glow_color;
+
+			float fill[ 4 ] = { src[ 0 ], src[ 1 ], src[ 2 ], src[ 3 ] * saturate( d / w + 0.5f ) };
+
+			// src is bgra like the framebuffer
+			float edge[ 4 ] = { outline_color.chan.b / 255.f, outline_color.chan.g / 255.f, outline_color.chan.r / 255.f, outline_color.chan.a / 255.f };
+			edge[ 3 ] *= outline > 0.f ? saturate( ( d + outline ) / w + 0.5f ) * src[ 3 ] : 0.f;
+
+			float halo[ 4 ] = { glow_color.chan.b / 255.f, glow_color.chan.g / 255.f, glow_color.chan.r / 255.f, glow_color.chan.a / 255.f };
+			halo[ 3 ] *= glow > 0.f ? saturate( 1.f + ( d + outline ) / glow ) * src[ 3 ] : 0.f;
+
+			float below[ 4 ];
+			over( edge, halo, below );
+			over( fill, below, src );
+		}
+
+		// color SRC_ALPHA/INV_SRC_ALPHA, alpha ONE/ZERO
+		static uint32_t blend( const uint32_t dst, const float src[ 4 ] ) noexcept
+		{
+			uint32_t out = 0;
+
+			for ( int c = 0; c < 3; ++c )
+			{
+				const float d = static_cast< float >( ( dst >> ( c * 8 ) ) & 0xFF ) / 255.f;
+				const float r = src[ c ] * src[ 3 ] + d * ( 1.f - src[ 3 ] );
+				out |= static_cast< uint32_t >( r * 255.f + 0.5f ) << ( c * 8 );
+			}
+
+			return out | static_cast< uint32_t >( src[ 3 ] * 255.f + 0.5f ) << 24;
+		}
+
+		// Mirrors shaders::shape_pixel_shader_src for a pixel local from the shape's center
+		static void shade_shape( const daisy_rect_t& shape, float local_x, float local_y, float src[ 4 ] ) noexcept
+		{
+			const auto saturate = [ ]( float f ) noexcept { return f < 0.f ? 0.f : ( f > 1.f ? 1.f : f ); };
+
+			const float half_w = shape.m_rect[ 2 ] * 0.5f, half_h = shape.m_rect[ 3 ] * 0.5f;
+			const float radius = min( max( shape.m_uv[ 0 ], 0.f ), min( half_w, half_h ) );
+
+			const float qx = fabsf( local_x ) - half_w + radius, qy = fabsf( local_y ) - half_h + radius;
+			const float ox = max( qx, 0.f ), oy = max( qy, 0.f );
+			const float d = sqrtf( ox * ox + oy * oy ) + min( max( qx, qy ), 0.f ) - radius;
+			const float w = max( shape.m_uv[ 2 ], 1.f );
+
+			const float outer = saturate( 0.5f - d / w );
+			const float inner = shape.m_uv[ 1 ] > 0.f ? saturate( 0.5f - ( d + shape.m_uv[ 1 ] ) / w ) : 1.f;
+
+			float fill[ 4 ], border[ 4 ];
+			for ( int c = 0; c < 4; ++c )
+			{
+				fill[ c ] = static_cast< float >( ( shape.m_col[ 0 ] >> ( c * 8 ) ) & 0xFF ) / 255.f;
+				border[ c ] = static_cast< float >( ( shape.m_col[ 1 ] >> ( c * 8 ) ) & 0xFF ) / 255.f;
+			}
+
+			const float a = border[ 3 ] + ( fill[ 3 ] - border[ 3 ] ) * inner;
+
+			for ( int c = 0; c < 3; ++c )
+				src[ c ] = ( border[ c ] * border[ 3 ] + ( fill[ c ] * fill[ 3 ] - border[ c ] * border[ 3 ] ) * inner ) / max( a, 1e-5f );
+
+			src[ 3 ] = a * outer;
+		}
+
+		void rasterize( const daisy_vtx_t& v0, const daisy_vtx_t& v1, const daisy_vtx_t& v2, const texture_t* texture, bool sdf = false ) noexcept
+		{
+			// same transform the vertex shader does, followed by the viewport transform onto our image
+			const float sx = static_cast< float >( this->m_width ) / daisy_t::s_viewport_width;
+			const float sy = static_cast< float >( this->m_height ) / daisy_t::s_viewport_height;
+
+			const daisy_vtx_t* v[ 3 ] = { &v0, &v1, &v2 };
+			float px[ 3 ], py[ 3 ];
+
+			for ( int i = 0; i < 3; ++i )
+			{
+				px[ i ] = v[ i ]->m_pos[ 0 ] * sx;
+				py[ i ] = v[ i ]->m_pos[ 1 ] * sy;
+			}
+
+			float area = ( px[ 1 ] - px[ 0 ] ) * ( py[ 2 ] - py[ 0 ] ) - ( py[ 1 ] - py[ 0 ] ) * ( px[ 2 ] - px[ 0 ] );
+			if ( area == 0.f )
+				return;
+
+			// no culling in our rasterizer state, normalize winding instead
+			if ( area < 0.f )
+			{
+				stl::swap( v[ 1 ], v[ 2 ] );
+				stl::swap( px[ 1 ], px[ 2 ] );
+				stl::swap( py[ 1 ], py[ 2 ] );
+				area = -area;
+			}
+
+			const float inv_area = 1.f / area;
+
+			// SDF triangles are scaled quads, one texel/pixel ratio for the whole triangle stands in for ddx/ddy
+			float texels_per_pixel = 1.f;
+			uint32_t style = 0;
+
+			if ( sdf )
+			{
+				const float du1 = ( v[ 1 ]->u( ) - v[ 0 ]->u( ) ) * texture->m_width, du2 = ( v[ 2 ]->u( ) - v[ 0 ]->u( ) ) * texture->m_width;
+				const float dv1 = ( v[ 1 ]->v( ) - v[ 0 ]->v( ) ) * texture->m_height, dv2 = ( v[ 2 ]->v( ) - v[ 0 ]->v( ) ) * texture->m_height;
+
+				const float du_dx = ( du1 * ( py[ 2 ] - py[ 0 ] ) - du2 * ( py[ 1 ] - py[ 0 ] ) ) * inv_area;
+				const float du_dy = ( du2 * ( px[ 1 ] - px[ 0 ] ) - du1 * ( px[ 2 ] - px[ 0 ] ) ) * inv_area;
+				const float dv_dx = ( dv1 * ( py[ 2 ] - py[ 0 ] ) - dv2 * ( py[ 1 ] - py[ 0 ] ) ) * inv_area;
+				const float dv_dy = ( dv2 * ( px[ 1 ] - px[ 0 ] ) - dv1 * ( px[ 2 ] - px[ 0 ] ) ) * inv_area;
+
+				texels_per_pixel = max( sqrtf( fabsf( du_dx * dv_dy - du_dy * dv_dx ) ), 1e-3f );
+				style = min( static_cast< uint32_t >( v0.slice( ) ), daisy_max_text_styles - 1 );
+			}
+
+			LONG min_x = static_cast< LONG >( floorf( min( px[ 0 ], min( px[ 1 ], px[ 2 ] ) ) ) );
+			LONG min_y = static_cast< LONG >( floorf( min( py[ 0 ], min( py[ 1 ], py[ 2 ] ) ) ) );
+			LONG max_x = static_cast< LONG >( ceilf( max( px[ 0 ], max( px[ 1 ], px[ 2 ] ) ) ) );
+			LONG max_y = static_cast< LONG >( ceilf( max( py[ 0 ], max( py[ 1 ], py[ 2 ] ) ) ) );
+
+			min_x = max( min_x, max( this->m_scissor.left, 0L ) );
+			min_y = max( min_y, max( this->m_scissor.top, 0L ) );
+			max_x = min( max_x, min( this->m_scissor.right, static_cast< LONG >( this->m_width ) ) );
+			max_y = min( max_y, min( this->m_scissor.bottom, static_cast< LONG >( this->m_height ) ) );
+
+			if ( min_x >= max_x || min_y >= max_y )
+				return;
+
+			float col[ 3 ][ 4 ];
+			for ( int i = 0; i < 3; ++i )
+			{
+				const uint32_t c = v[ i ]->m_col;
+				col[ i ][ 0 ] = static_cast< float >( ( c >> 0 ) & 0xFF );
+				col[ i ][ 1 ] = static_cast< float >( ( c >> 8 ) & 0xFF );
+				col[ i ][ 2 ] = static_cast< float >( ( c >> 16 ) & 0xFF );
+				col[ i ][ 3 ] = static_cast< float >( ( c >> 24 ) & 0xFF );
+			}
+
+			// edge i is opposite to vertex i
+			const bool top_left[ 3 ] = {
+				is_top_left( px[ 1 ], py[ 1 ], px[ 2 ], py[ 2 ] ),
+				is_top_left( px[ 2 ], py[ 2 ], px[ 0 ], py[ 0 ] ),
+				is_top_left( px[ 0 ], py[ 0 ], px[ 1 ], py[ 1 ] ) };
+
+			for ( LONG y = min_y; y < max_y; ++y )
+			{
+				const float cy = static_cast< float >( y ) + 0.5f;
+				uint32_t* row = this->m_framebuffer.data( ) + static_cast< size_t >( y ) * this->m_width;
+
+				for ( LONG x = min_x; x < max_x; ++x )
+				{
+					const float cx = static_cast< float >( x ) + 0.5f;
+
+					float w[ 3 ];
+					w[ 0 ] = ( px[ 2 ] - px[ 1 ] ) * ( cy - py[ 1 ] ) - ( py[ 2 ] - py[ 1 ] ) * ( cx - px[ 1 ] );
+					w[ 1 ] = ( px[ 0 ] - px[ 2 ] ) * ( cy - py[ 2 ] ) - ( py[ 0 ] - py[ 2 ] ) * ( cx - px[ 2 ] );
+					w[ 2 ] = ( px[ 1 ] - px[ 0 ] ) * ( cy - py[ 0 ] ) - ( py[ 1 ] - py[ 0 ] ) * ( cx - px[ 0 ] );
+
+					this->m_stats.m_pixels_tested++;
+
+					if ( w[ 0 ] < 0.f || w[ 1 ] < 0.f || w[ 2 ] < 0.f )
+						continue;
+
+					if ( ( w[ 0 ] == 0.f && !top_left[ 0 ] ) || ( w[ 1 ] == 0.f && !top_left[ 1 ] ) || ( w[ 2 ] == 0.f && !top_left[ 2 ] ) )
+						continue;
+
+					const float b0 = w[ 0 ] * inv_area, b1 = w[ 1 ] * inv_area, b2 = w[ 2 ] * inv_area;
+
+					const float u = b0 * v[ 0 ]->u( ) + b1 * v[ 1 ]->u( ) + b2 * v[ 2 ]->u( );
+					const float t = b0 * v[ 0 ]->v( ) + b1 * v[ 1 ]->v( ) + b2 * v[ 2 ]->v( );
+
+					// pixel shader: vertex color with texture alpha as a mask
+					float src[ 4 ];
+					for ( int c = 0; c < 4; ++c )
+						src[ c ] = ( b0 * col[ 0 ][ c ] + b1 * col[ 1 ][ c ] + b2 * col[ 2 ][ c ] ) / 255.f;
+
+					if ( sdf )
+						shade_sdf( src, this->sample_alpha_linear( texture, u, t ), texels_per_pixel, style );
+					else
+						src[ 3 ] *= this->sample_alpha( texture, u, t ) / 255.f;
+
+					row[ x ] = blend( row[ x ], src );
+					this->m_stats.m_pixels_written++;
+				}
+			}
+		}
+
+	public:
+		c_cpu_backend( ) noexcept
+			: m_scissor( { 0, 0, 0, 0 } ), m_width( 0 ), m_height( 0 ), m_stats( )
+		{
+		}
+
+		c_cpu_backend( const c_cpu_backend& ) = delete;
+		c_cpu_backend& operator=( const c_cpu_backend& ) = delete;
+
+		[[nodiscard]] bool create( const uint32_t width, const uint32_t height ) noexcept
+		{
+			if ( !width || !height )
+				return false;
+
+			this->m_width = width;
+			this->m_height = height;
+			this->m_framebuffer.assign( static_cast< size_t >( width ) * height, 0u );
+			this->m_scissor = { 0, 0, static_cast< LONG >( width ), static_cast< LONG >( height ) };
+
+			return true;
+		}
+
+		// Clears the image and resets the scissor rect, like daisy_prepare does for the device
+		void clear( const color_t& color = color_t( 0, 0, 0, 0 ) ) noexcept
+		{
+			stl::fill( this->m_framebuffer.begin( ), this->m_framebuffer.end( ), color.bgra );
+			this->m_scissor = { 0, 0, static_cast< LONG >( this->m_width ), static_cast< LONG >( this->m_height ) };
+		}
+
+		// Registers CPU-side BGRA pixels (width * height * 4 bytes) for a shader resource view
+		// pixels are BGRA, or one alpha byte per texel for DXGI_FORMAT_A8_UNORM (FONT_A8 fonts)
+		bool bind_texture( ID3D11ShaderResourceView* texture_srv, const uint32_t width, const uint32_t height, const uint8_t* bgra,
+			const DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM ) noexcept
+		{
+			if ( !texture_srv || !width || !height || !bgra )
+				return false;
+
+			auto& texture = this->m_textures[ texture_srv ];
+			texture.m_width = width;
+			texture.m_height = height;
+			texture.m_pixels.resize( static_cast< size_t >( width ) * height );
+
+			if ( format == DXGI_FORMAT_A8_UNORM )
+			{
+				for ( size_t i = 0; i < texture.m_pixels.size( ); i++ )
+					texture.m_pixels[ i ] = ( static_cast< uint32_t >( bgra[ i ] ) << 24 ) | 0x00FFFFFF;
+			}
+			else
+				memcpy( texture.m_pixels.data( ), bgra, texture.m_pixels.size( ) * sizeof( uint32_t ) );
+
+			return true;
+		}
+
+		void unbind_texture( ID3D11ShaderResourceView* texture_srv ) noexcept
+		{
+			this->m_textures.erase( texture_srv );
+		}
+
+		virtual bool upload( const renderbuffer_t& vtxs, const renderbuffer_t& idxs, const renderbuffer_t& rects, const renderbuffer_t& glyphs ) noexcept override
+		{
+			this->m_vtxs.resize( vtxs.m_size );
+			this->m_idxs.resize( idxs.m_size );
+			this->m_rects.resize( rects.m_size );
+			this->m_glyphs.resize( glyphs.m_size );
+
+			if ( vtxs.m_size )
+				memcpy( this->m_vtxs.data( ), vtxs.m_data.get( ), sizeof( daisy_vtx_t ) * vtxs.m_size );
+
+			if ( idxs.m_size )
+				memcpy( this->m_idxs.data( ), idxs.m_data.get( ), sizeof( daisy_idx_t ) * idxs.m_size );
+
+			if ( rects.m_size )
+				memcpy( this->m_rects.data( ), rects.m_data.get( ), sizeof( daisy_rect_t ) * rects.m_size );
+
+			if ( glyphs.m_size )
+				memcpy( this->m_glyphs.data( ), glyphs.m_data.get( ), sizeof( daisy_glyph_instance_t ) * glyphs.m_size );
+
+			this->m_stats.m_uploads++;
+			this->m_stats.m_upload_bytes += sizeof( daisy_vtx_t ) * vtxs.m_size + sizeof( daisy_idx_t ) * idxs.m_size +
+				sizeof( daisy_rect_t ) * rects.m_size + sizeof( daisy_glyph_instance_t ) * glyphs.m_size;
+
+			return true;
+		}
+
+		virtual void scissor( const point_t& position, const point_t& size ) noexcept override
+		{
+			this->m_scissor.left = static_cast< LONG >( position.x );
+			this->m_scissor.top = static_cast< LONG >( position.y );
+			this->m_scissor.right = static_cast< LONG >( position.x + size.x );
+			this->m_scissor.bottom = static_cast< LONG >( position.y + size.y );
+		}
+
+		virtual void draw_indexed( ID3D11ShaderResourceView* texture_srv, uint32_t indices, uint32_t start_index, uint32_t base_vertex ) noexcept override
+		{
+			if ( this->m_framebuffer.empty( ) || start_index + indices > this->m_idxs.size( ) )
+				return;
+
+			const texture_t* texture = nullptr;
+
+			if ( texture_srv )
+			{
+				const auto it = this->m_textures.find( texture_srv );
+				if ( it != this->m_textures.end( ) )
+					texture = &it->second;
+			}
+
+			const bool sdf = texture && daisy_t::s_sdf_textures.count( texture_srv );
+
+			this->m_stats.m_draws++;
+			this->m_stats.m_vertices += indices;
+
+			for ( uint32_t i = start_index; i + 2 < start_index + indices; i += 3 )
+			{
+				const uint32_t i0 = base_vertex + this->m_idxs[ i ];
+				const uint32_t i1 = base_vertex + this->m_idxs[ i + 1 ];
+				const uint32_t i2 = base_vertex + this->m_idxs[ i + 2 ];
+
+				if ( i0 >= this->m_vtxs.size( ) || i1 >= this->m_vtxs.size( ) || i2 >= this->m_vtxs.size( ) )
+					continue;
+
+				this->m_stats.m_triangles++;
+				this->rasterize( this->m_vtxs[ i0 ], this->m_vtxs[ i1 ], this->m_vtxs[ i2 ], texture, sdf );
+			}
+		}
+
+		virtual void draw_rects( ID3D11ShaderResourceView* texture_srv, uint32_t instances, uint32_t start_instance ) noexcept override
+		{
+			if ( this->m_framebuffer.empty( ) || start_instance + instances > this->m_rects.size( ) )
+				return;
+
+			const texture_t* texture = nullptr;
+
+			if ( texture_srv )
+			{
+				const auto it = this->m_textures.find( texture_srv );
+				if ( it != this->m_textures.end( ) )
+					texture = &it->second;
+			}
+
+			this->m_stats.m_draws++;
+
+			for ( uint32_t i = start_instance; i < start_instance + instances; ++i )
+			{
+				const auto& r = this->m_rects[ i ];
+
+				// same expansion as the rect vertex shader
+				const float x1 = floorf( r.m_rect[ 0 ] ), y1 = floorf( r.m_rect[ 1 ] );
+				const float x2 = floorf( r.m_rect[ 0 ] + r.m_rect[ 2 ] ), y2 = floorf( r.m_rect[ 1 ] + r.m_rect[ 3 ] );
+
+				const daisy_vtx_t quad[ 4 ] = {
+					daisy_make_vtx( x1, y1, r.m_col[ 0 ], r.m_uv[ 0 ], r.m_uv[ 1 ] ),
+					daisy_make_vtx( x2, y1, r.m_col[ 1 ], r.m_uv[ 2 ], r.m_uv[ 1 ] ),
+					daisy_make_vtx( x2, y2, r.m_col[ 3 ], r.m_uv[ 2 ], r.m_uv[ 3 ] ),
+					daisy_make_vtx( x1, y2, r.m_col[ 2 ], r.m_uv[ 0 ], r.m_uv[ 3 ] ) };
+
+				this->m_stats.m_vertices += 6;
+				this->m_stats.m_triangles += 2;
+				this->rasterize( quad[ 0 ], quad[ 1 ], quad[ 3 ], texture );
+				this->rasterize( quad[ 3 ], quad[ 2 ], quad[ 1 ], texture );
+			}
+		}
+
+		virtual void draw_shapes( uint32_t instances, uint32_t start_instance ) noexcept override
+		{
+			if ( this->m_framebuffer.empty( ) || start_instance + instances > this->m_rects.size( ) )
+				return;
+
+			const float sx = static_cast< float >( this->m_width ) / daisy_t::s_viewport_width;
+			const float sy = static_cast< float >( this->m_height ) / daisy_t::s_viewport_height;
+
+			this->m_stats.m_draws++;
+
+			for ( uint32_t i = start_instance; i < start_instance + instances; ++i )
+			{
+				const auto& shape = this->m_rects[ i ];
+
+				// same quad as the shape vertex shader, the pixel centers inside it get shaded
+				const float pad = max( shape.m_uv[ 2 ], 1.f ) * 0.5f + 1.f;
+				const float cx = shape.m_rect[ 0 ] + shape.m_rect[ 2 ] * 0.5f, cy = shape.m_rect[ 1 ] + shape.m_rect[ 3 ] * 0.5f;
+				const float ex = shape.m_rect[ 2 ] * 0.5f + pad, ey = shape.m_rect[ 3 ] * 0.5f + pad;
+
+				LONG min_x = static_cast< LONG >( ceilf( ( cx - ex ) * sx - 0.5f ) ), max_x = static_cast< LONG >( ceilf( ( cx + ex ) * sx - 0.5f ) );
+				LONG min_y = static_cast< LONG >( ceilf( ( cy - ey ) * sy - 0.5f ) ), max_y = static_cast< LONG >( ceilf( ( cy + ey ) * sy - 0.5f ) );
+
+				min_x = max( min_x, max( this->m_scissor.left, 0L ) );
+				min_y = max( min_y, max( this->m_scissor.top, 0L ) );
+				max_x = min( max_x, min( this->m_scissor.right, static_cast< LONG >( this->m_width ) ) );
+				max_y = min( max_y, min( this->m_scissor.bottom, static_cast< LONG >( this->m_height ) ) );
+
+				this->m_stats.m_vertices += 6;
+				this->m_stats.m_triangles += 2;
+
+				for ( LONG y = min_y; y < max_y; ++y )
+				{
+					uint32_t* row = this->m_framebuffer.data( ) + static_cast< size_t >( y ) * this->m_width;
+
+					for ( LONG x = min_x; x < max_x; ++x )
+					{
+						float src[ 4 ];
+						shade_shape( shape, ( x + 0.5f ) / sx - cx, ( y + 0.5f ) / sy - cy, src );
+
+						this->m_stats.m_pixels_tested++;
+						row[ x ] = blend( row[ x ], src );
+						this->m_stats.m_pixels_written++;
+					}
+				}
+			}
+		}
+
+		virtual void draw_glyphs( const c_fontwrapper& font, uint32_t instances, uint32_t start_instance ) noexcept override
+		{
+			if ( this->m_framebuffer.empty( ) || start_instance + instances > this->m_glyphs.size( ) )
+				return;
+
+			const texture_t* texture = nullptr;
+			uint32_t page = ~0u;
+
+			this->m_stats.m_draws++;
+
+			for ( uint32_t i = start_instance; i < start_instance + instances; ++i )
+			{
+				const auto& instance = this->m_glyphs[ i ];
+				const auto& glyph = font.glyph( instance.m_glyph );
+
+				// lazy fonts spread their glyphs over several textures
+				if ( font.glyph_page( instance.m_glyph ) != page )
+				{
+					page = font.glyph_page( instance.m_glyph );
+
+					const auto it = this->m_textures.find( font.page_srv( page ) );
+					texture = it != this->m_textures.end( ) ? &it->second : nullptr;
+				}
+
+				// same expansion as the glyph vertex shader
+				const float x1 = instance.m_pos[ 0 ], y1 = instance.m_pos[ 1 ];
+				const float x2 = x1 + glyph.m_size[ 0 ], y2 = y1 + glyph.m_size[ 1 ];
+
+				const daisy_vtx_t quad[ 4 ] = {
+					daisy_make_vtx( x1, y1, instance.m_col, glyph.m_uv[ 0 ], glyph.m_uv[ 1 ] ),
+					daisy_make_vtx( x2, y1, instance.m_col, glyph.m_uv[ 2 ], glyph.m_uv[ 1 ] ),
+					daisy_make_vtx( x2, y2, instance.m_col, glyph.m_uv[ 2 ], glyph.m_uv[ 3 ] ),
+					daisy_make_vtx( x1, y2, instance.m_col, glyph.m_uv[ 0 ], glyph.m_uv[ 3 ] ) };
+
+				this->m_stats.m_vertices += 6;
+				this->m_stats.m_triangles += 2;
+				this->rasterize( quad[ 0 ], quad[ 1 ], quad[ 3 ], texture );
+				this->rasterize( quad[ 3 ], quad[ 2 ], quad[ 1 ], texture );
+			}
+		}
+
+		const uint32_t* pixels( ) const noexcept
+		{
+			return this->m_framebuffer.data( );
+		}
+		uint32_t width( ) const noexcept
+		{
+			return this->m_width;
+		}
+		uint32_t height( ) const noexcept
+		{
+			return this->m_height;
+		}
+		const stats_t& stats( ) const noexcept
+		{
+			return this->m_stats;
+		}
+		void reset_stats( ) noexcept
+		{
+			this->m_stats = stats_t { };
+		}
+	};
+
+	// One push_text call laid out at the origin, kept by c_text_cache
+	struct daisy_text_run_t
+	{
+		struct segment_t
+		{
+			ID3D11ShaderResourceView* m_texture_srv;
+			uint32_t m_vertices, m_indices, m_primitives;
+		};
+
+		uint64_t m_key;
+		stl::string m_id; // push_text parameters followed by the code units, compared on a hash hit
+		stl::vector<daisy_vtx_t> m_vtxs;
+		stl::vector<daisy_idx_t> m_idxs; // relative to the first vertex of their segment
+		stl::vector<segment_t> m_segments; // one per drawcall push_text started
+		uint32_t m_prev, m_next; // LRU list, most recently used first
+	};
+
+	// Bounded LRU of laid-out text runs, see c_renderqueue::set_text_cache
+	// - evicted runs are reused in place, so a full cache stops allocating once its runs have grown
+	class c_text_cache
+	{
+	public:
+		struct stats_t
+		{
+			uint64_t m_hits { 0 }, m_misses { 0 }, m_evictions { 0 };
+		};
+
+	private:
+		static constexpr uint32_t none = ~0u;
+
+		stl::vector<daisy_text_run_t> m_runs;
+		stl::unordered_map<uint64_t, uint32_t> m_lookup;
+		uint32_t m_capacity = 0, m_head = none, m_tail = none;
+		stats_t m_stats;
+
+	private:
+		void unlink( daisy_text_run_t& run ) noexcept
+		{
+			( run.m_prev != none ? this->m_runs[ run.m_prev ].m_next : this->m_head ) = run.m_next;
+			( run.m_next != none ? this->m_runs[ run.m_next ].m_prev : this->m_tail ) = run.m_prev;
+		}
+
+		void link_front( daisy_text_run_t& run, uint32_t index ) noexcept
+		{
+			run.m_prev = none;
+			run.m_next = this->m_head;
+
+			if ( this->m_head != none )
+				this->m_runs[ this->m_head ].m_prev = index;
+			else
+				this->m_tail = index;
+
+			this->m_head = index;
+		}
+
+	public:
+		// Drops every run, 0 turns the cache off
+		void set_capacity( uint32_t runs ) noexcept
+		{
+			this->clear( );
+			this->m_capacity = runs;
+		}
+
+		uint32_t capacity( ) const noexcept
+		{
+			return this->m_capacity;
+		}
+
+		size_t size( ) const noexcept
+		{
+			return this->m_runs.size( );
+		}
+
+		void clear( ) noexcept
+		{
+			this->m_runs.clear( );
+			this->m_lookup.clear( );
+			this->m_head = this->m_tail = none;
+		}
+
+		// The run recorded for id, marked as most recently used, or nullptr
+		daisy_text_run_t* find( uint64_t key, const stl::string& id ) noexcept
+		{
+			const auto it = this->m_lookup.find( key );
+			if ( it == this->m_lookup.end( ) || this->m_runs[ it->second ].m_id != id )
+			{
+				this->m_stats.m_misses++;
+				return nullptr;
+			}
+
+			auto& run = this->m_runs[ it->second ];
+
+			if ( this->m_head != it->second )
+			{
+				this->unlink( run );
+				this->link_front( run, it->second );
+			}
+
+			this->m_stats.m_hits++;
+			return &run;
+		}
+
+		// An empty run for id, evicting the least recently used one when full
+		// - a hash collision replaces the run that had the key
+		daisy_text_run_t& insert( uint64_t key, const stl::string& id ) noexcept
+		{
+			uint32_t index;
+
+			const auto it = this->m_lookup.find( key );
+			if ( it != this->m_lookup.end( ) )
+			{
+				index = it->second;
+				this->unlink( this->m_runs[ index ] );
+			}
+			else if ( this->m_runs.size( ) < this->m_capacity )
+			{
+				index = static_cast< uint32_t >( this->m_runs.size( ) );
+				this->m_runs.emplace_back( );
+			}
+			else
+			{
+				index = this->m_tail;
+				this->unlink( this->m_runs[ index ] );
+				this->m_lookup.erase( this->m_runs[ index ].m_key );
+				this->m_stats.m_evictions++;
+			}
+
+			auto& run = this->m_runs[ index ];
+			run.m_key = key;
+			run.m_id = id;
+			run.m_vtxs.clear( );
+			run.m_idxs.clear( );
+			run.m_segments.clear( );
+
+			this->m_lookup[ key ] = index;
+			this->link_front( run, index );
+
+			return run;
+		}
+
+		const stats_t& stats( ) const noexcept
+		{
+			return this->m_stats;
+		}
+		void reset_stats( ) noexcept
+		{
+			this->m_stats = stats_t { };
+		}
+	};
+
+	// Path of straight and curved subpaths for c_renderqueue::push_path_stroke/push_path_fill
+	// - curves are flattened as they are added, to within tolerance( ) pixels
+	class c_path
+	{
+	public:
+		struct subpath_t
+		{
+			uint32_t m_first, m_count;
+			bool m_closed;
+		};
+
+	private:
+		stl::vector<point_t> m_points;
+		stl::vector<subpath_t> m_subpaths;
+		float m_tolerance = 0.25f;
+
+	private:
+		subpath_t& current( ) noexcept
+		{
+			if ( this->m_subpaths.empty( ) || this->m_subpaths.back( ).m_closed )
+			{
+				// a closed subpath ends where it started, carry on from there like a move_to
+				const point_t start = this->m_subpaths.empty( ) ? point_t { 0.f, 0.f } : this->m_points[ this->m_subpaths.back( ).m_first ];
+				this->move_to( start );
+			}
+
+			return this->m_subpaths.back( );
+		}
+
+		// Segments keeping a curve whose control polygon bends by deviation pixels within tolerance
+		uint32_t curve_segments( float deviation, float scale ) const noexcept
+		{
+			const float segments = ceilf( sqrtf( deviation * scale / this->m_tolerance ) );
+			return segments < 1.f ? 1u : ( segments > 256.f ? 256u : static_cast< uint32_t >( segments ) );
+		}
+
+	public:
+		void clear( ) noexcept
+		{
+			this->m_points.clear( );
+			this->m_subpaths.clear( );
+		}
+
+		void set_tolerance( float tolerance ) noexcept
+		{
+			this->m_tolerance = tolerance > 0.f ? tolerance : 0.25f;
+		}
+
+		float tolerance( ) const noexcept
+		{
+			return this->m_tolerance;
+		}
+
+		// Starts a new subpath at point
+		void move_to( const point_t& point ) noexcept
+		{
+			if ( !this->m_subpaths.empty( ) && this->m_subpaths.back( ).m_count == 1 && !this->m_subpaths.back( ).m_closed )
+			{
+				// a move_to right after a move_to only moves the start
+				this->m_points.back( ) = point;
+				return;
+			}
+
+			this->m_subpaths.push_back( subpath_t { static_cast< uint32_t >( this->m_points.size( ) ), 1, false } );
+			this->m_points.push_back( point );
+		}
+
+		void line_to( const point_t& point ) noexcept
+		{
+			auto& subpath = this->current( );
+			this->m_points.push_back( point );
+			subpath.m_count++;
+		}
+
+		// Quadratic bezier from the current point through control to point
+		void quad_to( const point_t& control, const point_t& point ) noexcept
+		{
+			auto& subpath = this->current( );
+			const point_t start = this->m_points.back( );
+
+			const float dx = start.x - 2.f * control.x + point.x, dy = start.y - 2.f * control.y + point.y;
+			const uint32_t segments = this->curve_segments( sqrtf( dx * dx + dy * dy ), 0.25f );
+
+			for ( uint32_t i = 1; i <= segments; i++ )
+			{
+				const float t = static_cast< float >( i ) / segments, u = 1.f - t;
+				this->m_points.push_back( point_t { u * u * start.x + 2.f * u * t * control.x + t * t * point.x,
+					u * u * start.y + 2.f * u * t * control.y + t * t * point.y } );
+			}
+
+			subpath.m_count += segments;
+		}
+
+		// Cubic bezier from the current point through control1 and control2 to point
+		void bezier_to( const point_t& control1, const point_t& control2, const point_t& point ) noexcept
+		{
+			auto& subpath = this->current( );
+			const point_t start = this->m_points.back( );
+
+			const float ax = start.x - 2.f * control1.x + control2.x, ay = start.y - 2.f * control1.y + control2.y;
+			const float bx = control1.x - 2.f * control2.x + point.x, by = control1.y - 2.f * control2.y + point.y;
+			const uint32_t segments = this->curve_segments( sqrtf( max( ax * ax + ay * ay, bx * bx + by * by ) ), 0.75f );
+
+			for ( uint32_t i = 1; i <= segments; i++ )
+			{
+				const float t = static_cast< float >( i ) / segments, u = 1.f - t;
+				const float w0 = u * u * u, w1 = 3.f * u * u * t, w2 = 3.f * u * t * t, w3 = t * t * t;
+
+				this->m_points.push_back( point_t { w0 * start.x + w1 * control1.x + w2 * control2.x + w3 * point.x,
+					w0 * start.y + w1 * control1.y + w2 * control2.y + w3 * point.y } );
+			}
+
+			subpath.m_count += segments;
+		}
+
+		// Joins the current subpath's end back to its start, the next segment starts a new subpath
+		void close( ) noexcept
+		{
+			if ( !this->m_subpaths.empty( ) )
+				this->m_subpaths.back( ).m_closed = true;
+		}
+
+		const stl::vector<point_t>& points( ) const noexcept
+		{
+			return this->m_points;
+		}
+
+		const stl::vector<subpath_t>& subpaths( ) const noexcept
+		{
+			return this->m_subpaths;
+		}
+	};
+
+	// Render queue class - continues in next part due to length
+	class c_renderqueue : public c_daisy_resettable_object
+	{
+		friend class c_parallel_queue;
+
+	private:
+		ID3D11Buffer* m_vertex_buffer = nullptr;
+		ID3D11Buffer* m_index_buffer = nullptr;
+		ID3D11Buffer* m_constant_buffer = nullptr;
+		ID3D11Buffer* m_instance_buffer = nullptr;
+		ID3D11Buffer* m_glyph_instance_buffer = nullptr;
+		c_daisy_backend* m_backend = nullptr;
+
+		renderbuffer_t m_vtxs, m_idxs, m_rects, m_glyphs;
+		ringbuffer_t m_vtx_ring, m_idx_ring;
+		stl::vector<uint64_t> m_vtx_blocks, m_idx_blocks, m_rect_blocks, m_glyph_blocks;
+		float m_uploaded_viewport[ 2 ];
+		stl::vector<daisy_drawcall_t> m_drawcalls;
+
+		bool m_update;
+		bool m_realloc_vtx, m_realloc_idx, m_realloc_rect, m_realloc_glyph;
+		bool m_instanced_rects, m_instanced_glyphs;
+		bool m_texture_array;
+		bool m_ring_upload;
+		bool m_retained, m_default_buffers, m_unchanged;
+		uint32_t m_text_style;
+
+		// text run cache: push_text lays a missing run out into m_run_vtxs/m_run_idxs/m_run_drawcalls,
+		// m_run_id is scratch for the lookup
+		c_text_cache m_text_cache;
+		renderbuffer_t m_run_vtxs, m_run_idxs;
+		stl::vector<daisy_drawcall_t> m_run_drawcalls;
+		stl::string m_run_id;
+		bool m_recording_run;
+
+		// unit circle tables by segment count, m_arc_directions is scratch for arcs and pies
+		stl::unordered_map<uint32_t, stl::vector<point_t>> m_circle_tables;
+		stl::vector<point_t> m_arc_directions;
+		float m_circle_tolerance;
+
+		// paths are tessellated into m_path_points/m_path_indices (relative to the first point) and copied out as
+		// one batch, or several when a drawcall can't index them all; m_path_polygon, m_path_ears and the batch
+		// numbering in m_path_remap/m_path_batch are scratch
+		stl::vector<point_t> m_path_points, m_path_polygon;
+		stl::vector<uint32_t> m_path_indices, m_path_ears, m_path_remap, m_path_batch;
+		static constexpr uint32_t path_unmapped = ~0u;
+
+	private:
+		void ensure_buffers_capacity( const uint32_t vertices_to_add, const uint32_t indices_to_add ) noexcept
+		{
+			if ( this->m_vtxs.m_size + vertices_to_add > this->m_vtxs.m_capacity )
+			{
+				while ( this->m_vtxs.m_size + vertices_to_add > this->m_vtxs.m_capacity )
+					this->m_vtxs.m_capacity = this->m_vtxs.m_capacity * 2;
+
+				auto new_vtx = stl::make_unique<uint8_t[ ]>( this->m_vtxs.m_capacity * sizeof( daisy_vtx_t ) );
+
+				if ( new_vtx )
+				{
+					memcpy( new_vtx.get( ), this->m_vtxs.m_data.get( ), this->m_vtxs.m_size * sizeof( daisy_vtx_t ) );
+					this->m_realloc_vtx = true;
+					this->m_vtxs.m_data.swap( new_vtx );
+				}
+			}
+
+			if ( this->m_idxs.m_size + indices_to_add > this->m_idxs.m_capacity )
+			{
+				while ( this->m_idxs.m_size + indices_to_add > this->m_idxs.m_capacity )
+					this->m_idxs.m_capacity = this->m_idxs.m_capacity * 2;
+
+				auto new_idx = stl::make_unique<uint8_t[ ]>( this->m_idxs.m_capacity * sizeof( daisy_idx_t ) );
+
+				if ( new_idx )
+				{
+					memcpy( new_idx.get( ), this->m_idxs.m_data.get( ), this->m_idxs.m_size * sizeof( daisy_idx_t ) );
+					this->m_realloc_idx = true;
+					this->m_idxs.m_data.swap( new_idx );
+				}
+			}
+		}
+
+		void ensure_rects_capacity( const uint32_t rects_to_add ) noexcept
+		{
+			if ( this->m_rects.m_size + rects_to_add > this->m_rects.m_capacity )
+			{
+				while ( this->m_rects.m_size + rects_to_add > this->m_rects.m_capacity )
+					this->m_rects.m_capacity = this->m_rects.m_capacity * 2;
+
+				auto new_rects = stl::make_unique<uint8_t[ ]>( this->m_rects.m_capacity * sizeof( daisy_rect_t ) );
+
+				if ( new_rects )
+				{
+					memcpy( new_rects.get( ), this->m_rects.m_data.get( ), this->m_rects.m_size * sizeof( daisy_rect_t ) );
+					this->m_realloc_rect = true;
+					this->m_rects.m_data.swap( new_rects );
+				}
+			}
+		}
+
+		void ensure_glyphs_capacity( const uint32_t glyphs_to_add ) noexcept
+		{
+			if ( this->m_glyphs.m_size + glyphs_to_add > this->m_glyphs.m_capacity )
+			{
+				while ( this->m_glyphs.m_size + glyphs_to_add > this->m_glyphs.m_capacity )
+					this->m_glyphs.m_capacity = this->m_glyphs.m_capacity * 2;
+
+				auto new_glyphs = stl::make_unique<uint8_t[ ]>( this->m_glyphs.m_capacity * sizeof( daisy_glyph_instance_t ) );
+
+				if ( new_glyphs )
+				{
+					memcpy( new_glyphs.get( ), this->m_glyphs.m_data.get( ), this->m_glyphs.m_size * sizeof( daisy_glyph_instance_t ) );
+					this->m_realloc_glyph = true;
+					this->m_glyphs.m_data.swap( new_glyphs );
+				}
+			}
+		}
+
+		template <typename t>
+		void push_glyph_instances( c_fontwrapper& font, point_t position, const t text, const color_t& color, const float line_height ) noexcept
+		{
+			this->ensure_glyphs_capacity( static_cast< uint32_t >( text.size( ) ) );
+
+			daisy_glyph_instance_t* glyphs = reinterpret_cast< daisy_glyph_instance_t* >( this->m_glyphs.m_data.get( ) ) + this->m_glyphs.m_size;
+			uint32_t count = 0, run = 0, page = 0;
+
+			const float start_x = position.x;
+
+			auto points = daisy_code_points( text );
+
+			for ( uint32_t c; points.next( c ); )
+			{
+				if ( c == '\n' )
+				{
+					position.x = start_x;
+					position.y += line_height;
+					continue;
+				}
+
+				const uint32_t id = font.glyph_id( c );
+				const auto& glyph = font.glyph( id );
+
+				if ( c != ' ' )
+				{
+					// one drawcall per texture page of a lazy font
+					if ( font.glyph_page( id ) != page )
+					{
+						if ( run )
+							this->push_glyph_run( font, page, run );
+
+						page = font.glyph_page( id );
+						run = 0;
+					}
+
+					glyphs[ count++ ] = daisy_glyph_instance_t { { position.x, position.y }, id, color.bgra };
+					run++;
+				}
+
+				position.x += glyph.m_advance;
+			}
+
+			if ( !count )
+				return;
+
+			this->m_glyphs.m_size += count;
+			this->m_update = true;
+
+			this->push_glyph_run( font, page, run );
+		}
+
+		template <typename t>
+		void push_cached_text( c_fontwrapper& font, const point_t& position, const t text, const color_t& color, uint16_t alignment, float size ) noexcept
+		{
+			// everything the layout depends on, then the code units
+			const uint32_t params[ ] = { font.generation( ), color.bgra, alignment, this->m_text_style, this->m_texture_array };
+			const uintptr_t font_id = reinterpret_cast< uintptr_t >( &font );
+
+			this->m_run_id.assign( reinterpret_cast< const char* >( &font_id ), sizeof( font_id ) );
+			this->m_run_id.append( reinterpret_cast< const char* >( params ), sizeof( params ) );
+			this->m_run_id.append( reinterpret_cast< const char* >( &size ), sizeof( size ) );
+			this->m_run_id.append( reinterpret_cast< const char* >( text.data( ) ), text.size( ) * sizeof( text[ 0 ] ) );
+
+			const uint64_t key = daisy_hash( reinterpret_cast< const uint8_t* >( this->m_run_id.data( ) ), this->m_run_id.size( ) );
+
+			const daisy_text_run_t* run = this->m_text_cache.find( key, this->m_run_id );
+			if ( !run )
+			{
+				auto& recorded = this->m_text_cache.insert( key, this->m_run_id );
+				this->record_text_run( recorded, font, text, color, alignment, size );
+				run = &recorded;
+			}
+
+			this->push_text_run( *run, position );
+		}
+
+		// Lays text out at the origin into the run buffers, the queue's own recording is swapped out meanwhile
+		template <typename t>
+		void record_text_run( daisy_text_run_t& run, c_fontwrapper& font, const t text, const color_t& color, uint16_t alignment, float size ) noexcept
+		{
+			const bool update = this->m_update, realloc_vtx = this->m_realloc_vtx, realloc_idx = this->m_realloc_idx;
+
+			this->m_run_vtxs.m_size = this->m_run_idxs.m_size = 0;
+			this->m_run_drawcalls.clear( );
+
+			stl::swap( this->m_vtxs, this->m_run_vtxs );
+			stl::swap( this->m_idxs, this->m_run_idxs );
+			stl::swap( this->m_drawcalls, this->m_run_drawcalls );
+
+			this->m_recording_run = true;
+			this->push_text( font, point_t { 0.f, 0.f }, text, color, alignment, size );
+			this->m_recording_run = false;
+
+			stl::swap( this->m_vtxs, this->m_run_vtxs );
+			stl::swap( this->m_idxs, this->m_run_idxs );
+			stl::swap( this->m_drawcalls, this->m_run_drawcalls );
+
+			this->m_update = update;
+			this->m_realloc_vtx = realloc_vtx;
+			this->m_realloc_idx = realloc_idx;
+
+			const auto* vtxs = reinterpret_cast< const daisy_vtx_t* >( this->m_run_vtxs.m_data.get( ) );
+			const auto* idxs = reinterpret_cast< const daisy_idx_t* >( this->m_run_idxs.m_data.get( ) );
+
+			run.m_vtxs.assign( vtxs, vtxs + this->m_run_vtxs.m_size );
+			run.m_idxs.assign( idxs, idxs + this->m_run_idxs.m_size );
+
+			for ( const auto& cmd : this->m_run_drawcalls )
+			{
+				if ( cmd.m_tri.m_indices )
+					run.m_segments.push_back( { cmd.m_tri.m_texture_srv, cmd.m_tri.m_vertices, cmd.m_tri.m_indices, cmd.m_tri.m_primitives } );
+			}
+		}
+
+		// Copies a recorded run to position, merging into the previous drawcall like push_text would
+		void push_text_run( const daisy_text_run_t& run, const point_t& position ) noexcept
+		{
+			if ( run.m_segments.empty( ) )
+				return;
+
+			this->ensure_buffers_capacity( static_cast< uint32_t >( run.m_vtxs.size( ) ), static_cast< uint32_t >( run.m_idxs.size( ) ) );
+
+			const daisy_vtx_t* src_vtx = run.m_vtxs.data( );
+			const daisy_idx_t* src_idx = run.m_idxs.data( );
+
+			for ( const auto& segment : run.m_segments )
+			{
+				const uint32_t additional_indices = this->begin_batch( segment.m_texture_srv, segment.m_vertices );
+
+				daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( this->m_vtxs.m_data.get( ) ) + this->m_vtxs.m_size;
+				daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( this->m_idxs.m_data.get( ) ) + this->m_idxs.m_size;
+
+				memcpy( static_cast< void* >( vtx ), src_vtx, sizeof( daisy_vtx_t ) * segment.m_vertices );
+
+				for ( uint32_t i = 0; i < segment.m_vertices; i++ )
+				{
+					vtx[ i ].m_pos[ 0 ] += position.x;
+					vtx[ i ].m_pos[ 1 ] += position.y;
+				}
+
+				for ( uint32_t i = 0; i < segment.m_indices; i++ )
+					idx[ i ] = static_cast< daisy_idx_t >( src_idx[ i ] + additional_indices );
+
+				this->m_vtxs.m_size += segment.m_vertices;
+				this->m_idxs.m_size += segment.m_indices;
+
+				this->end_batch( additional_indices, segment.m_vertices, segment.m_indices, segment.m_primitives, segment.m_texture_srv );
+
+				src_vtx += segment.m_vertices;
+				src_idx += segment.m_indices;
+			}
+		}
+
+		void push_glyph_run( const c_fontwrapper& font, uint32_t page, uint32_t count ) noexcept
+		{
+			if ( !this->m_drawcalls.empty( ) )
+			{
+				auto& last_call = this->m_drawcalls.back( );
+				if ( last_call.m_kind == daisy_call_kind::CALL_GLYPH && last_call.m_glyph.m_font == &font && last_call.m_glyph.m_page == page )
+				{
+					last_call.m_glyph.m_instances += count;
+					return;
+				}
+			}
+
+			daisy_drawcall_t d {};
+			d.m_kind = daisy_call_kind::CALL_GLYPH;
+			d.m_glyph.m_font = &font;
+			d.m_glyph.m_instances = count;
+			d.m_glyph.m_page = page;
+
+			this->m_drawcalls.push_back( stl::move( d ) );
+		}
+
+		void push_rect_instance( const daisy_rect_t& rect, ID3D11ShaderResourceView* texture_srv ) noexcept
+		{
+			this->ensure_rects_capacity( 1 );
+
+			reinterpret_cast< daisy_rect_t* >( this->m_rects.m_data.get( ) )[ this->m_rects.m_size++ ] = rect;
+
+			if ( !this->m_drawcalls.empty( ) )
+			{
+				auto& last_call = this->m_drawcalls.back( );
+				if ( last_call.m_kind == daisy_call_kind::CALL_RECT && last_call.m_rect.m_texture_srv == texture_srv )
+				{
+					last_call.m_rect.m_instances++;
+					this->m_update = true;
+					return;
+				}
+			}
+
+			daisy_drawcall_t d {};
+			d.m_kind = daisy_call_kind::CALL_RECT;
+			d.m_rect.m_texture_srv = texture_srv;
+			d.m_rect.m_instances = 1;
+
+			this->m_drawcalls.push_back( stl::move( d ) );
+			this->m_update = true;
+		}
+
+		void push_shape_instance( const daisy_rect_t& shape ) noexcept
+		{
+			this->ensure_rects_capacity( 1 );
+
+			reinterpret_cast< daisy_rect_t* >( this->m_rects.m_data.get( ) )[ this->m_rects.m_size++ ] = shape;
+			this->m_update = true;
+
+			if ( !this->m_drawcalls.empty( ) && this->m_drawcalls.back( ).m_kind == daisy_call_kind::CALL_SHAPE )
 			{
-				OutputDebugStringA( ( char* ) error_blob->GetBufferPointer( ) );
-				error_blob->Release( );
+				this->m_drawcalls.back( ).m_rect.m_instances++;
+				return;
 			}
-			return false;
-		}
 
-		if ( error_blob )
-			error_blob->Release( );
+			daisy_drawcall_t d {};
+			d.m_kind = daisy_call_kind::CALL_SHAPE;
+			d.m_rect.m_texture_srv = nullptr;
+			d.m_rect.m_instances = 1;
 
-		return true;
-	}
+			this->m_drawcalls.push_back( stl::move( d ) );
+		}
 
-	// Font wrapper class
-	class c_fontwrapper : public c_daisy_resettable_object
-	{
-	private:
-		stl::unordered_map<wchar_t, uv_t> m_coords;
-		stl::string_view m_family;
-		ID3D11Texture2D* m_texture = nullptr;
-		ID3D11ShaderResourceView* m_texture_srv = nullptr;
-		float m_scale;
-		uint32_t m_width, m_height, m_spacing, m_size, m_quality;
-		uint8_t m_flags;
+		// Binds the input assembler/vertex shader state for CALL_TRI, CALL_RECT, CALL_GLYPH or CALL_SHAPE
+		void bind_pipeline( daisy_call_kind kind ) noexcept
+		{
+			switch ( kind )
+			{
+			case daisy_call_kind::CALL_RECT:
+			case daisy_call_kind::CALL_GLYPH:
+			case daisy_call_kind::CALL_SHAPE:
+			{
+				const bool rects = kind != daisy_call_kind::CALL_GLYPH;
+
+				ID3D11Buffer* buffers[ 2 ] = { daisy_t::s_unit_quad_vtx, rects ? this->m_instance_buffer : this->m_glyph_instance_buffer };
+				UINT strides[ 2 ] = { sizeof( float ) * 2, static_cast< UINT >( rects ? sizeof( daisy_rect_t ) : sizeof( daisy_glyph_instance_t ) ) };
+				UINT offsets[ 2 ] = { 0, 0 };
+				daisy_t::s_context->IASetVertexBuffers( 0, 2, buffers, strides, offsets );
+				daisy_t::s_context->IASetIndexBuffer( daisy_t::s_unit_quad_idx, DXGI_FORMAT_R16_UINT, 0 );
+				daisy_t::s_context->IASetInputLayout( rects ? daisy_t::s_rect_input_layout : daisy_t::s_glyph_input_layout );
+				daisy_t::s_context->VSSetShader( kind == daisy_call_kind::CALL_SHAPE ? daisy_t::s_shape_vertex_shader :
+					( rects ? daisy_t::s_rect_vertex_shader : daisy_t::s_glyph_vertex_shader ), nullptr, 0 );
+				break;
+			}
+			default:
+			{
+				UINT stride = sizeof( daisy_vtx_t );
+				UINT offset = 0;
+				daisy_t::s_context->IASetVertexBuffers( 0, 1, &this->m_vertex_buffer, &stride, &offset );
+				daisy_t::s_context->IASetIndexBuffer( this->m_index_buffer, daisy_idx_format, 0 );
+				daisy_t::s_context->IASetInputLayout( daisy_t::s_input_layout );
+				daisy_t::s_context->VSSetShader( daisy_t::s_vertex_shader, nullptr, 0 );
+				break;
+			}
+			}
+		}
 
-	private:
-		bool create_ex( ) noexcept
+		static bool create_dynamic_buffer( const uint32_t byte_width, const UINT bind_flags, ID3D11Buffer** buffer ) noexcept
 		{
-			if ( !daisy_t::s_device )
-				return false;
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = byte_width;
+			desc.Usage = D3D11_USAGE_DYNAMIC;
+			desc.BindFlags = bind_flags;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-			HDC gdi_ctx = nullptr;
-			HGDIOBJ gdi_font = nullptr, prev_gdi_font = nullptr, prev_bitmap = nullptr;
-			HBITMAP bitmap = nullptr;
+			return SUCCEEDED( daisy_t::s_device->CreateBuffer( &desc, nullptr, buffer ) );
+		}
 
-			// Release old texture if exists
-			if ( m_texture_srv )
+		// Maps a texture to the srv its drawcall binds and the slice/uv scale its vertices carry
+		// - in texture array mode the white texture and every registered texture share daisy_t::s_texture_array_srv
+		daisy_slice_t texture_slot( ID3D11ShaderResourceView*& texture_srv ) const noexcept
+		{
+			if ( this->m_texture_array && daisy_t::s_texture_array_srv )
 			{
-				m_texture_srv->Release( );
-				m_texture_srv = nullptr;
+				// the white texture is a single texel, so every uv collapses onto it
+				if ( !texture_srv )
+				{
+					texture_srv = daisy_t::s_texture_array_srv;
+					return daisy_slice_t { 0.f, { 0.f, 0.f } };
+				}
+
+				const auto it = daisy_t::s_texture_slices.find( texture_srv );
+				if ( it != daisy_t::s_texture_slices.end( ) )
+				{
+					texture_srv = daisy_t::s_texture_array_srv;
+					return it->second;
+				}
 			}
-			if ( m_texture )
+
+			return daisy_slice_t { 0.f, { 1.f, 1.f } };
+		}
+
+		// Explicit segment counts are clamped, 0 or less picks one for radius
+		uint32_t circle_segments( float radius, int segments ) const noexcept
+		{
+			if ( segments > 0 )
+				return min( max( static_cast< uint32_t >( segments ), 3u ), daisy_max_circle_segments );
+
+			return daisy_circle_segments( radius, this->m_circle_tolerance );
+		}
+
+		// Unit vectors at 2pi * i / segments, built on first use of each segment count
+		const stl::vector<point_t>& circle_table( uint32_t segments ) noexcept
+		{
+			auto& table = this->m_circle_tables[ segments ];
+			if ( table.empty( ) )
 			{
-				m_texture->Release( );
-				m_texture = nullptr;
+				table.resize( segments );
+
+				for ( uint32_t i = 0; i < segments; i++ )
+				{
+					const float theta = ( 2.f * daisy_pi * i ) / segments;
+					table[ i ] = point_t { cosf( theta ), sinf( theta ) };
+				}
 			}
 
-			gdi_ctx = CreateCompatibleDC( nullptr );
-			SetMapMode( gdi_ctx, MM_TEXT );
+			return table;
+		}
 
-			this->create_gdi_font( gdi_ctx, &gdi_font );
-			prev_gdi_font = SelectObject( gdi_ctx, gdi_font );
+		// Unit vectors from angle from to angle to (radians, from < to < from + 2pi): exact ends with the circle
+		// table's directions in between, so an arc costs two sincos whatever its length
+		const stl::vector<point_t>& arc_directions( float from, float to, uint32_t segments ) noexcept
+		{
+			const auto& table = this->circle_table( segments );
+			const float steps = segments / ( 2.f * daisy_pi );
 
-			this->m_width = this->m_height = 128;
+			auto& directions = this->m_arc_directions;
+			directions.clear( );
+			directions.push_back( point_t { cosf( from ), sinf( from ) } );
 
-			while ( this->paint_or_measure_alphabet( gdi_ctx, true ) == 2 )
+			// table directions within a hundredth of a step of an end would only add a sliver
+			const int64_t first = static_cast< int64_t >( floorf( from * steps + 0.01f ) ) + 1;
+			const int64_t last = static_cast< int64_t >( ceilf( to * steps - 0.01f ) ) - 1;
+
+			for ( int64_t i = first; i <= last; i++ )
 			{
-				this->m_width *= 2;
-				this->m_height *= 2;
+				const int64_t wrapped = i % static_cast< int64_t >( segments );
+				directions.push_back( table[ static_cast< size_t >( wrapped < 0 ? wrapped + segments : wrapped ) ] );
 			}
 
-			// D3D11 doesn't have device caps in the same way, use reasonable max
-			const uint32_t max_texture_size = 16384;
+			directions.push_back( point_t { cosf( to ), sinf( to ) } );
+			return directions;
+		}
 
-			if ( this->m_width > max_texture_size )
-			{
-				this->m_scale = static_cast< float >( max_texture_size ) / this->m_width;
-				this->m_width = this->m_height = max_texture_size;
+		// Triangle fan from center out to radius along count directions, closed joins the last back to the first
+		void push_fan( const point_t& center, const float radius, const point_t* directions, const uint32_t count, const bool closed,
+			const color_t& center_color, const color_t& outer_color ) noexcept
+		{
+			const uint32_t triangles = closed ? count : count - 1;
+			this->ensure_buffers_capacity( count + 1, triangles * 3 );
 
-				bool first_iteration = true;
+			ID3D11ShaderResourceView* texture_srv = nullptr;
+			this->texture_slot( texture_srv );
 
-				do
-				{
-					if ( !first_iteration )
-						this->m_scale *= 0.9f;
+			uint32_t additional_indices = this->begin_batch( texture_srv, count + 1 );
 
-					DeleteObject( SelectObject( gdi_ctx, prev_gdi_font ) );
-					this->create_gdi_font( gdi_ctx, &gdi_font );
-					prev_gdi_font = SelectObject( gdi_ctx, gdi_font );
-					first_iteration = false;
-				} while ( this->paint_or_measure_alphabet( gdi_ctx, true ) == 2 );
+			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
+
+			vtx[ 0 ] = daisy_make_vtx( center.x, center.y, center_color.bgra, 0.f, 0.f );
+
+			for ( uint32_t i = 0; i < count; i++ )
+				vtx[ i + 1 ] = daisy_make_vtx( center.x + radius * directions[ i ].x, center.y + radius * directions[ i ].y, outer_color.bgra, 0.f, 0.f );
+
+			for ( uint32_t i = 0; i < triangles; i++ )
+			{
+				idx[ i * 3 ] = static_cast< daisy_idx_t >( additional_indices );
+				idx[ i * 3 + 1 ] = static_cast< daisy_idx_t >( additional_indices + 1 + i );
+				idx[ i * 3 + 2 ] = static_cast< daisy_idx_t >( additional_indices + 1 + ( i + 1 ) % count );
 			}
 
-			// Create D3D11 texture
-			D3D11_TEXTURE2D_DESC tex_desc = {};
-			tex_desc.Width = this->m_width;
-			tex_desc.Height = this->m_height;
-			tex_desc.MipLevels = 1;
-			tex_desc.ArraySize = 1;
-			tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM; // Use full 8-bit per channel for better quality
-			tex_desc.SampleDesc.Count = 1;
-			tex_desc.Usage = D3D11_USAGE_DYNAMIC;
-			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			tex_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			this->m_vtxs.m_size += count + 1;
+			this->m_idxs.m_size += triangles * 3;
 
-			HRESULT hr = daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &this->m_texture );
-			if ( FAILED( hr ) || !this->m_texture )
-				return false;
+			this->end_batch( additional_indices, count + 1, triangles * 3, triangles, texture_srv );
+		}
 
-			// Create shader resource view
-			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
-			srv_desc.Format = tex_desc.Format;
-			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-			srv_desc.Texture2D.MipLevels = 1;
+		// Quad strip between inner_radius and outer_radius along count directions, closed joins the last back to the first
+		void push_band( const point_t& center, const float inner_radius, const float outer_radius, const point_t* directions, const uint32_t count,
+			const bool closed, const color_t& col ) noexcept
+		{
+			const uint32_t quads = closed ? count : count - 1;
+			this->ensure_buffers_capacity( count * 2, quads * 6 );
 
-			hr = daisy_t::s_device->CreateShaderResourceView( this->m_texture, &srv_desc, &this->m_texture_srv );
-			if ( FAILED( hr ) )
-				return false;
+			ID3D11ShaderResourceView* texture_srv = nullptr;
+			this->texture_slot( texture_srv );
 
-			DWORD* bitmap_bits = nullptr;
+			uint32_t additional_indices = this->begin_batch( texture_srv, count * 2 );
 
-			BITMAPINFO bitmap_ctx {};
-			bitmap_ctx.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
-			bitmap_ctx.bmiHeader.biWidth = this->m_width;
-			bitmap_ctx.bmiHeader.biHeight = -static_cast< int32_t >( this->m_height );
-			bitmap_ctx.bmiHeader.biPlanes = 1;
-			bitmap_ctx.bmiHeader.biCompression = BI_RGB;
-			bitmap_ctx.bmiHeader.biBitCount = 32;
+			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
 
-			bitmap = CreateDIBSection( gdi_ctx, &bitmap_ctx, DIB_RGB_COLORS, reinterpret_cast< void** >( &bitmap_bits ), nullptr, 0 );
-			if ( !bitmap || !bitmap_bits )
-				return false;
+			for ( uint32_t i = 0; i < count; i++ )
+			{
+				vtx[ i * 2 ] = daisy_make_vtx( center.x + inner_radius * directions[ i ].x, center.y + inner_radius * directions[ i ].y, col.bgra, 0.f, 0.f );
+				vtx[ i * 2 + 1 ] = daisy_make_vtx( center.x + outer_radius * directions[ i ].x, center.y + outer_radius * directions[ i ].y, col.bgra, 0.f, 0.f );
+			}
 
-			prev_bitmap = SelectObject( gdi_ctx, bitmap );
+			for ( uint32_t i = 0; i < quads; i++ )
+			{
+				const uint32_t a = additional_indices + i * 2, b = additional_indices + ( ( i + 1 ) % count ) * 2;
+
+				idx[ i * 6 ] = static_cast< daisy_idx_t >( a );
+				idx[ i * 6 + 1 ] = static_cast< daisy_idx_t >( a + 1 );
+				idx[ i * 6 + 2 ] = static_cast< daisy_idx_t >( b + 1 );
+				idx[ i * 6 + 3 ] = static_cast< daisy_idx_t >( b + 1 );
+				idx[ i * 6 + 4 ] = static_cast< daisy_idx_t >( b );
+				idx[ i * 6 + 5 ] = static_cast< daisy_idx_t >( a );
+			}
 
-			SetTextColor( gdi_ctx, RGB( 255, 255, 255 ) );
-			SetBkColor( gdi_ctx, 0x00000000 );
-			SetBkMode( gdi_ctx, OPAQUE );
-			SetTextAlign( gdi_ctx, TA_TOP );
+			this->m_vtxs.m_size += count * 2;
+			this->m_idxs.m_size += quads * 6;
 
-			if ( this->paint_or_measure_alphabet( gdi_ctx, false ) )
-				return false;
+			this->end_batch( additional_indices, count * 2, quads * 6, quads * 2, texture_srv );
+		}
 
-			// Map texture and write data
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			hr = daisy_t::s_context->Map( this->m_texture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped );
-			if ( FAILED( hr ) )
-				return false;
+		// Copies m_path_points/m_path_indices into the vertex/index streams and empties them
+		// - more vertices than a drawcall can index go out as consecutive runs of triangles, each repeating the
+		//   vertices it shares with the run before, so a stroke splits at a segment boundary and a fan into smaller fans
+		void push_path_mesh( const color_t& col ) noexcept
+		{
+			const uint32_t indices = static_cast< uint32_t >( this->m_path_indices.size( ) );
 
-			uint8_t* dst_row = static_cast< uint8_t* >( mapped.pData );
+			if ( this->m_path_points.size( ) > daisy_max_batch_vertices )
+				this->m_path_remap.assign( this->m_path_points.size( ), path_unmapped );
 
-			// Write RGBA data
-			// GDI renders white text_w on black background
-			// We store white RGB (255,255,255) with luminance as alpha
-			for ( uint32_t y = 0; y < this->m_height; y++ )
+			for ( uint32_t first = 0; first < indices; )
+				first = this->push_path_batch( col, first );
+
+			this->m_path_points.clear( );
+			this->m_path_indices.clear( );
+		}
+
+		// Copies the triangles of m_path_indices from first on that one drawcall can index, returns where it stopped
+		uint32_t push_path_batch( const color_t& col, const uint32_t first ) noexcept
+		{
+			const auto& path_indices = this->m_path_indices;
+			const bool whole = this->m_path_points.size( ) <= daisy_max_batch_vertices;
+
+			uint32_t last = static_cast< uint32_t >( path_indices.size( ) );
+			auto& remap = this->m_path_remap;
+			auto& batch = this->m_path_batch;
+
+			if ( !whole )
 			{
-				uint8_t* dst = dst_row;
-				for ( uint32_t x = 0; x < this->m_width; x++ )
+				// number the vertices in order of use until the next triangle no longer fits
+				batch.clear( );
+
+				for ( last = first; last < path_indices.size( ); last += 3 )
 				{
-					// GDI bitmap format is BGRA (B at byte 0, G at 1, R at 2, A at 3)
-					DWORD pixel = bitmap_bits[ this->m_width * y + x ];
+					uint32_t fresh = 0;
+					for ( uint32_t k = 0; k < 3; k++ )
+						fresh += remap[ path_indices[ last + k ] ] == path_unmapped;
 
-					// Extract color components
-					BYTE b = ( pixel >> 0 ) & 0xFF;
-					BYTE g = ( pixel >> 8 ) & 0xFF;
-					BYTE r = ( pixel >> 16 ) & 0xFF;
+					if ( batch.size( ) + fresh > daisy_max_batch_vertices )
+						break;
 
-					// Calculate luminance - max of RGB channels for white text_w
-					BYTE intensity = max( max( r, g ), b );
+					for ( uint32_t k = 0; k < 3; k++ )
+					{
+						const uint32_t vertex = path_indices[ last + k ];
+						if ( remap[ vertex ] == path_unmapped )
+						{
+							remap[ vertex ] = static_cast< uint32_t >( batch.size( ) );
+							batch.push_back( vertex );
+						}
+					}
+				}
+			}
 
-					// Write R8G8B8A8: R, G, B, A in memory order
-					dst[ 0 ] = 255;      // R - full white
-					dst[ 1 ] = 255;      // G - full white  
-					dst[ 2 ] = 255;      // B - full white
-					dst[ 3 ] = intensity; // A - text_w opacity (0=transparent, 255=solid)
+			const uint32_t vertices = whole ? static_cast< uint32_t >( this->m_path_points.size( ) ) : static_cast< uint32_t >( batch.size( ) );
+			const uint32_t indices = last - first;
 
-					dst += 4;
-				}
-				dst_row += mapped.RowPitch;
+			this->ensure_buffers_capacity( vertices, indices );
+
+			ID3D11ShaderResourceView* texture_srv = nullptr;
+			this->texture_slot( texture_srv );
+
+			uint32_t additional_indices = this->begin_batch( texture_srv, vertices );
+
+			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
+
+			if ( whole )
+			{
+				for ( uint32_t i = 0; i < vertices; i++ )
+					vtx[ i ] = daisy_make_vtx( this->m_path_points[ i ].x, this->m_path_points[ i ].y, col.bgra, 0.f, 0.f );
+
+				for ( uint32_t i = 0; i < indices; i++ )
+					idx[ i ] = static_cast< daisy_idx_t >( additional_indices + path_indices[ first + i ] );
+			}
+			else
+			{
+				for ( uint32_t i = 0; i < vertices; i++ )
+					vtx[ i ] = daisy_make_vtx( this->m_path_points[ batch[ i ] ].x, this->m_path_points[ batch[ i ] ].y, col.bgra, 0.f, 0.f );
+
+				for ( uint32_t i = 0; i < indices; i++ )
+					idx[ i ] = static_cast< daisy_idx_t >( additional_indices + remap[ path_indices[ first + i ] ] );
+
+				// the next run numbers its vertices afresh, shared ones included
+				for ( const uint32_t vertex : batch )
+					remap[ vertex ] = path_unmapped;
 			}
 
-			daisy_t::s_context->Unmap( this->m_texture, 0 );
+			this->m_vtxs.m_size += vertices;
+			this->m_idxs.m_size += indices;
 
-			SelectObject( gdi_ctx, prev_bitmap );
-			SelectObject( gdi_ctx, prev_gdi_font );
-			DeleteObject( bitmap );
-			DeleteObject( gdi_font );
-			DeleteDC( gdi_ctx );
+			this->end_batch( additional_indices, vertices, indices, indices / 3, texture_srv );
 
-			return true;
+			return last;
 		}
 
-		void create_gdi_font( HDC context, HGDIOBJ* gdi_font ) noexcept
+		// Copies points into m_path_polygon without repeats, closed also drops an end that repeats the start
+		uint32_t path_polygon( const point_t* points, const uint32_t count, const bool closed ) noexcept
 		{
-			*gdi_font = CreateFontA( this->m_size, 0, 0, 0, ( this->m_flags & FONT_BOLD ) ? FW_BOLD : FW_NORMAL,
-				( this->m_flags & FONT_ITALIC ) ? TRUE : FALSE, FALSE, FALSE, DEFAULT_CHARSET,
-				OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, this->m_quality, VARIABLE_PITCH, this->m_family.data( ) );
+			const auto same = [ ]( const point_t& a, const point_t& b ) noexcept { return fabsf( a.x - b.x ) < 1e-4f && fabsf( a.y - b.y ) < 1e-4f; };
+
+			auto& polygon = this->m_path_polygon;
+			polygon.clear( );
+
+			for ( uint32_t i = 0; i < count; i++ )
+			{
+				if ( polygon.empty( ) || !same( polygon.back( ), points[ i ] ) )
+					polygon.push_back( points[ i ] );
+			}
+
+			if ( closed && polygon.size( ) > 2 && same( polygon.front( ), polygon.back( ) ) )
+				polygon.pop_back( );
+
+			return static_cast< uint32_t >( polygon.size( ) );
 		}
 
-		int paint_or_measure_alphabet( HDC context, bool measure = false ) noexcept
+		void path_triangle( uint32_t a, uint32_t b, uint32_t c ) noexcept
 		{
-			SIZE size;
-			wchar_t chr[ ] = L"x\0\0";
+			this->m_path_indices.push_back( a );
+			this->m_path_indices.push_back( b );
+			this->m_path_indices.push_back( c );
+		}
 
-			if ( !GetTextExtentPoint32W( context, chr, 1, &size ) )
-				return 1;
+		uint32_t path_point( const point_t& point ) noexcept
+		{
+			this->m_path_points.push_back( point );
+			return static_cast< uint32_t >( this->m_path_points.size( ) - 1 );
+		}
 
-			const auto unicode_ranges_size = GetFontUnicodeRanges( context, nullptr );
-			if ( !unicode_ranges_size )
-				return 1;
+		// Fan from hub over an arc of radius around center, from direction from turning by angle radians,
+		// first and last are the points already at its ends
+		void path_arc( const point_t& center, const float radius, point_t from, const float angle, const uint32_t hub, const uint32_t first, const uint32_t last ) noexcept
+		{
+			const uint32_t segments = this->circle_segments( radius, 0 );
+			const uint32_t steps = max( static_cast< uint32_t >( ceilf( fabsf( angle ) * segments / ( 2.f * daisy_pi ) ) ), 1u );
 
-			auto glyph_sets_memory = stl::make_unique<uint8_t[ ]>( unicode_ranges_size );
-			if ( !glyph_sets_memory )
-				return 1;
+			// one sincos for the whole arc, each point rotates the previous one
+			const float c = cosf( angle / steps ), s = sinf( angle / steps );
+			uint32_t previous = first;
 
-			auto glyph_sets = reinterpret_cast< GLYPHSET* >( glyph_sets_memory.get( ) );
+			for ( uint32_t i = 1; i < steps; i++ )
+			{
+				from = point_t { from.x * c - from.y * s, from.x * s + from.y * c };
 
-			if ( !GetFontUnicodeRanges( context, glyph_sets ) )
-				return 1;
+				const uint32_t index = this->path_point( point_t { center.x + from.x * radius, center.y + from.y * radius } );
+				this->path_triangle( hub, previous, index );
+				previous = index;
+			}
+
+			this->path_triangle( hub, previous, last );
+		}
 
-			this->m_spacing = static_cast< uint32_t >( ceil( size.cy * 0.3f ) );
+		// Appends the stroke of a polyline: each point gets one vertex pair shared by the segments on either side
+		// (miter), or a shared inner vertex and one outer vertex per segment with the gap bevelled or rounded
+		void stroke_polyline( const point_t* points, const uint32_t count, bool closed, const float width, const daisy_line_join join, const daisy_line_cap cap,
+			const float miter_limit ) noexcept
+		{
+			const uint32_t n = this->path_polygon( points, count, closed );
+			if ( n < 2 || width <= 0.f )
+				return;
 
-			uint32_t x = this->m_spacing;
-			uint32_t y = 0;
+			if ( n == 2 )
+				closed = false;
 
-			for ( uint32_t r = 0; r < glyph_sets->cRanges; ++r )
+			const auto& polygon = this->m_path_polygon;
+			const float hw = width * 0.5f;
+
+			const auto segment = [ & ]( uint32_t i, point_t& direction ) noexcept
 			{
-				for ( auto ch = glyph_sets->ranges[ r ].wcLow; ch < ( glyph_sets->ranges[ r ].wcLow + glyph_sets->ranges[ r ].cGlyphs ); ++ch )
+				const point_t& a = polygon[ i ];
+				const point_t& b = polygon[ ( i + 1 ) % n ];
+				const float dx = b.x - a.x, dy = b.y - a.y, length = sqrtf( dx * dx + dy * dy ), inverse = 1.f / length;
+
+				direction = point_t { dx * inverse, dy * inverse };
+				return length;
+			};
+
+			// each segment is measured once, the outgoing one of a point is the incoming one of the next
+			point_t a, b;
+			float length_in = 0.f, length_out = closed ? segment( n - 1, b ) : segment( 0, b );
+
+			// vertex pair ending the incoming segment and starting the outgoing one, +normal side first
+			uint32_t end_pair[ 2 ] = { 0, 0 }, start_pair[ 2 ] = { 0, 0 }, previous[ 2 ] = { 0, 0 }, closing[ 2 ] = { 0, 0 };
+
+			for ( uint32_t i = 0; i < n; i++ )
+			{
+				const point_t& p = polygon[ i ];
+
+				if ( !closed && ( i == 0 || i == n - 1 ) )
 				{
-					if ( !GetTextExtentPoint32W( context, &ch, 1, &size ) )
-						continue;
+					const bool start = i == 0;
 
-					if ( x + size.cx + this->m_spacing > this->m_width )
-					{
-						x = this->m_spacing;
-						y += size.cy + 1;
-					}
+					// b is segment 0 at the start and still segment n - 2 at the end
+					const point_t d = b;
+					const point_t normal { -d.y, d.x };
+					const float extend = cap == LINE_CAP_SQUARE ? ( start ? -hw : hw ) : 0.f;
+					const point_t base { p.x + d.x * extend, p.y + d.y * extend };
+
+					const uint32_t left = this->path_point( point_t { base.x + normal.x * hw, base.y + normal.y * hw } );
+					const uint32_t right = this->path_point( point_t { base.x - normal.x * hw, base.y - normal.y * hw } );
+
+					// half turn from +normal through -d (start) or d (end) to -normal
+					if ( cap == LINE_CAP_ROUND )
+						this->path_arc( p, hw, normal, start ? daisy_pi : -daisy_pi, this->path_point( p ), left, right );
+
+					end_pair[ 0 ] = start_pair[ 0 ] = left;
+					end_pair[ 1 ] = start_pair[ 1 ] = right;
+				}
+				else
+				{
+					a = b;
+					length_in = length_out;
+					length_out = segment( i, b );
 
-					if ( y + size.cy > this->m_height )
-						return 2;
+					const point_t na { -a.y, a.x }, nb { -b.y, b.x };
+					const float cross = a.x * b.y - a.y * b.x, dot = a.x * b.x + a.y * b.y;
+					const point_t m { na.x + nb.x, na.y + nb.y };
+					const float m_length = sqrtf( m.x * m.x + m.y * m.y );
 
-					if ( !measure )
+					// |na + nb| is 2 cos( turn / 2 ), the miter is hw / cos( turn / 2 ) long
+					if ( ( fabsf( cross ) < 1e-4f && dot > 0.f ) || ( join == LINE_JOIN_MITER && m_length > 1e-4f && 2.f / m_length <= miter_limit ) )
 					{
-						if ( !ExtTextOutW( context, x + 0, y + 0, ETO_OPAQUE, nullptr, &ch, 1, nullptr ) )
-							return 1;
+						const float scale = fabsf( cross ) < 1e-4f ? hw : 2.f * hw / m_length;
+						const point_t offset = fabsf( cross ) < 1e-4f ? point_t { na.x * hw, na.y * hw } : point_t { m.x / m_length * scale, m.y / m_length * scale };
 
-						this->m_coords[ static_cast< uint16_t >( ch ) ][ 0 ] = ( static_cast< float >( x + 0 - this->m_spacing ) ) / this->m_width;
-						this->m_coords[ static_cast< uint16_t >( ch ) ][ 1 ] = ( static_cast< float >( y + 0 + 0 ) ) / this->m_height;
-						this->m_coords[ static_cast< uint16_t >( ch ) ][ 2 ] = ( static_cast< float >( x + size.cx + this->m_spacing ) ) / this->m_width;
-						this->m_coords[ static_cast< uint16_t >( ch ) ][ 3 ] = ( static_cast< float >( y + size.cy + 0 ) ) / this->m_height;
+						end_pair[ 0 ] = start_pair[ 0 ] = this->path_point( point_t { p.x + offset.x, p.y + offset.y } );
+						end_pair[ 1 ] = start_pair[ 1 ] = this->path_point( point_t { p.x - offset.x, p.y - offset.y } );
+					}
+					else
+					{
+						// turning towards +normal puts the inner corner on that side, its miter is kept within the shorter segment
+						const float side = cross > 0.f ? 1.f : -1.f;
+						point_t inner = p;
+
+						if ( m_length > 1e-4f )
+						{
+							const float shorter = min( length_in, length_out );
+							const float inner_length = min( 2.f * hw / m_length, sqrtf( hw * hw + shorter * shorter ) ) * side;
+							inner = point_t { p.x + m.x / m_length * inner_length, p.y + m.y / m_length * inner_length };
+						}
+
+						const uint32_t vi = this->path_point( inner );
+						const uint32_t va = this->path_point( point_t { p.x - na.x * hw * side, p.y - na.y * hw * side } );
+						const uint32_t vb = this->path_point( point_t { p.x - nb.x * hw * side, p.y - nb.y * hw * side } );
+
+						if ( join == LINE_JOIN_ROUND )
+							this->path_arc( p, hw, point_t { -na.x * side, -na.y * side }, atan2f( cross, dot ), vi, va, vb );
+						else
+							this->path_triangle( vi, va, vb );
+
+						end_pair[ 0 ] = side > 0.f ? vi : va;
+						end_pair[ 1 ] = side > 0.f ? va : vi;
+						start_pair[ 0 ] = side > 0.f ? vi : vb;
+						start_pair[ 1 ] = side > 0.f ? vb : vi;
 					}
+				}
 
-					x += size.cx + ( 2 * this->m_spacing );
+				if ( i )
+				{
+					this->path_triangle( previous[ 0 ], previous[ 1 ], end_pair[ 1 ] );
+					this->path_triangle( end_pair[ 1 ], end_pair[ 0 ], previous[ 0 ] );
 				}
+				else
+				{
+					closing[ 0 ] = end_pair[ 0 ];
+					closing[ 1 ] = end_pair[ 1 ];
+				}
+
+				previous[ 0 ] = start_pair[ 0 ];
+				previous[ 1 ] = start_pair[ 1 ];
 			}
 
-			return 0;
+			if ( closed )
+			{
+				this->path_triangle( previous[ 0 ], previous[ 1 ], closing[ 1 ] );
+				this->path_triangle( closing[ 1 ], closing[ 0 ], previous[ 0 ] );
+			}
 		}
 
-	public:
-		c_fontwrapper( ) noexcept
-			: m_family( ), m_scale( 0.f ), m_width( 0 ), m_height( 0 ), m_spacing( 0 ), m_size( 0 ), m_quality( NONANTIALIASED_QUALITY ), m_flags( 0 )
+		// Appends the fill of a simple polygon: a fan when it's convex, ear clipping otherwise
+		void fill_polygon( const point_t* points, const uint32_t count ) noexcept
 		{
-		}
+			const uint32_t n = this->path_polygon( points, count, true );
+			if ( n < 3 )
+				return;
 
-		~c_fontwrapper( )
-		{
-			erase( );
-		}
+			const auto& polygon = this->m_path_polygon;
+			const auto cross = [ ]( const point_t& a, const point_t& b, const point_t& c ) noexcept { return ( b.x - a.x ) * ( c.y - b.y ) - ( b.y - a.y ) * ( c.x - b.x ); };
 
-		c_fontwrapper( const c_fontwrapper& ) = delete;
-		c_fontwrapper& operator=( const c_fontwrapper& ) = delete;
+			float area = 0.f;
+			for ( uint32_t i = 0; i < n; i++ )
+				area += polygon[ i ].x * polygon[ ( i + 1 ) % n ].y - polygon[ ( i + 1 ) % n ].x * polygon[ i ].y;
 
-		[[nodiscard]] bool create( const stl::string_view family, uint32_t height, uint32_t quality, uint8_t flags ) noexcept
-		{
-			this->m_family = family;
-			this->m_size = height;
-			this->m_flags = flags;
-			this->m_quality = quality;
-			this->m_scale = 1.f;
-			this->m_spacing = 0;
+			if ( fabsf( area ) < 1e-6f )
+				return;
 
-			return this->create_ex( );
-		}
+			const float winding = area > 0.f ? 1.f : -1.f;
+			const uint32_t base = static_cast< uint32_t >( this->m_path_points.size( ) );
+			this->m_path_points.insert( this->m_path_points.end( ), polygon.begin( ), polygon.end( ) );
 
-		template <typename t = stl::string_view>
-		point_t text_extent( t text ) noexcept
-		{
-			float row_width = 0.f;
-			float row_height = ( this->m_coords[ static_cast< wchar_t > ( 32 ) ][ 3 ] - this->m_coords[ static_cast< wchar_t > ( 32 ) ][ 1 ] ) * this->m_height;
-			float width = 0.f;
-			float height = row_height;
+			bool convex = true;
+			for ( uint32_t i = 0; i < n && convex; i++ )
+				convex = cross( polygon[ ( i + n - 1 ) % n ], polygon[ i ], polygon[ ( i + 1 ) % n ] ) * winding >= 0.f;
 
-			for ( const auto c : text )
+			if ( convex )
 			{
-				if ( c == '\n' )
+				for ( uint32_t i = 1; i + 1 < n; i++ )
+					this->path_triangle( base, base + i, base + i + 1 );
+				return;
+			}
+
+			auto& ears = this->m_path_ears;
+			ears.resize( n );
+			for ( uint32_t i = 0; i < n; i++ )
+				ears[ i ] = i;
+
+			// a full lap without an ear means the polygon intersects itself, the rest is fanned
+			for ( uint32_t i = 0, misses = 0; ears.size( ) > 3 && misses < ears.size( ); )
+			{
+				const uint32_t size = static_cast< uint32_t >( ears.size( ) );
+				const uint32_t prev = ears[ ( i + size - 1 ) % size ], cur = ears[ i % size ], next = ears[ ( i + 1 ) % size ];
+				const float corner = cross( polygon[ prev ], polygon[ cur ], polygon[ next ] ) * winding;
+
+				bool ear = corner >= 0.f;
+
+				for ( uint32_t j = 0; j < size && ear && corner > 0.f; j++ )
 				{
-					row_width = 0.f;
-					height += row_height;
+					const uint32_t other = ears[ j ];
+					if ( other == prev || other == cur || other == next )
+						continue;
+
+					const point_t& q = polygon[ other ];
+					if ( ( q.x == polygon[ prev ].x && q.y == polygon[ prev ].y ) || ( q.x == polygon[ next ].x && q.y == polygon[ next ].y ) )
+						continue;
+
+					ear = !( cross( polygon[ prev ], polygon[ cur ], q ) * winding >= 0.f && cross( polygon[ cur ], polygon[ next ], q ) * winding >= 0.f &&
+						cross( polygon[ next ], polygon[ prev ], q ) * winding >= 0.f );
 				}
 
-				if ( c < ' ' )
+				if ( !ear )
+				{
+					i = ( i + 1 ) % size;
+					misses++;
 					continue;
+				}
 
-				float tx1 = this->m_coords[ static_cast< wchar_t >( c ) ][ 0 ];
-				float tx2 = this->m_coords[ static_cast< wchar_t >( c ) ][ 2 ];
-
-				row_width += ( tx2 - tx1 ) * this->m_width - 2.f * this->m_spacing + 1.f;
+				// collinear corners are dropped without a triangle
+				if ( corner > 0.f )
+					this->path_triangle( base + prev, base + cur, base + next );
 
-				if ( row_width > width )
-					width = row_width;
+				ears.erase( ears.begin( ) + i % size );
+				i = i % static_cast< uint32_t >( ears.size( ) );
+				misses = 0;
 			}
 
-			return { width, height };
+			for ( uint32_t i = 1; i + 1 < ears.size( ); i++ )
+				this->path_triangle( base + ears[ 0 ], base + ears[ i ], base + ears[ i + 1 ] );
 		}
 
-		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		// Returns the vertex offset to merge into the previous drawcall, or 0 to start a new one
+		// - never merges past daisy_max_batch_vertices so indices cannot wrap
+		uint32_t begin_batch( ID3D11ShaderResourceView* texture_srv, const uint32_t vertices ) const noexcept
 		{
-			if ( !pre_reset )
-				return this->create_ex( );
-			else
+			uint32_t additional = 0;
+
+			if ( !this->m_drawcalls.empty( ) )
 			{
-				if ( m_texture_srv )
-				{
-					m_texture_srv->Release( );
-					m_texture_srv = nullptr;
-				}
-				if ( m_texture )
+				auto& last_call = this->m_drawcalls.back( );
+				if ( last_call.m_kind == daisy_call_kind::CALL_TRI && last_call.m_tri.m_texture_srv == texture_srv &&
+					static_cast< uint64_t >( last_call.m_tri.m_vertices ) + vertices <= daisy_max_batch_vertices )
 				{
-					m_texture->Release( );
-					m_texture = nullptr;
+					additional = last_call.m_tri.m_vertices;
 				}
 			}
-			return true;
+
+			return additional;
 		}
 
-		void erase( ) noexcept
+		void end_batch( uint32_t additional_indices, uint32_t vertices, uint32_t indices, uint32_t primitives, ID3D11ShaderResourceView* texture_srv = nullptr )
 		{
-			if ( m_texture_srv )
+			if ( !additional_indices )
 			{
-				m_texture_srv->Release( );
-				m_texture_srv = nullptr;
+				daisy_drawcall_t d {};
+				d.m_kind = daisy_call_kind::CALL_TRI;
+				d.m_tri.m_indices = indices;
+				d.m_tri.m_vertices = vertices;
+				d.m_tri.m_texture_srv = texture_srv;
+				d.m_tri.m_primitives = primitives;
+
+				this->m_drawcalls.push_back( stl::move( d ) );
 			}
-			if ( m_texture )
+			else
 			{
-				m_texture->Release( );
-				m_texture = nullptr;
-			}
-
-			this->m_coords.clear( );
-			this->m_size = this->m_spacing = this->m_flags = 0;
-			this->m_scale = 1.f;
-			this->m_family = "";
-		}
+				auto& last_call = this->m_drawcalls.back( );
 
-		// Getters
-		template <typename t = char>
-		const uv_t& coords( t glyph ) const noexcept
-		{
-			if ( this->m_coords.find( glyph ) != this->m_coords.end( ) )
-				return this->m_coords.at( glyph );
+				last_call.m_tri.m_vertices += vertices;
+				last_call.m_tri.m_indices += indices;
+				last_call.m_tri.m_primitives += primitives;
+			}
 
-			static uv_t null_uv { 0.f, 0.f, 0.f, 0.f };
-			return null_uv;
+			this->m_update = true;
 		}
 
-		uint32_t spacing( ) const noexcept
-		{
-			return this->m_spacing;
-		}
-		uint32_t width( ) const noexcept
-		{
-			return this->m_width;
-		}
-		uint32_t height( ) const noexcept
-		{
-			return this->m_height;
-		}
-		float scale( ) const noexcept
-		{
-			return this->m_scale;
-		}
-		ID3D11ShaderResourceView* texture_srv( ) const noexcept
+		// Compares buffer against the block hashes of its last upload, returns false when nothing changed
+		// - [first, last) receives the dirty byte range, blocks is updated to the new contents
+		static bool dirty_span( const renderbuffer_t& buffer, const size_t stride, stl::vector<uint64_t>& blocks, uint32_t& first, uint32_t& last ) noexcept
 		{
-			return this->m_texture_srv;
-		}
-	};
-
-	class c_texatlas : public c_daisy_resettable_object
-	{
-	private:
-		point_t m_cursor, m_dimensions;
-		ID3D11Texture2D* m_texture = nullptr;
-		ID3D11ShaderResourceView* m_texture_srv = nullptr;
-		float m_max_height;
+			const size_t size = buffer.m_size * stride;
+			const size_t count = ( size + daisy_retained_block - 1 ) / daisy_retained_block;
+			const size_t known = blocks.size( );
 
-	public:
-		stl::unordered_map<uint32_t, uv_t> m_coords;
+			blocks.resize( count );
 
-		c_texatlas( ) noexcept
-			: m_cursor( { 0.f, 0.f } ), m_dimensions( { 0.f, 0.f } ), m_max_height( 0.f )
-		{
-		}
+			size_t dirty_first = count, dirty_last = 0;
 
-		~c_texatlas( )
-		{
-			if ( m_texture_srv )
-				m_texture_srv->Release( );
-			if ( m_texture )
-				m_texture->Release( );
-		}
+			for ( size_t block = 0; block < count; block++ )
+			{
+				const size_t offset = block * daisy_retained_block;
+				const uint64_t hash = daisy_hash( buffer.m_data.get( ) + offset, min( size - offset, static_cast< size_t >( daisy_retained_block ) ) );
 
-		c_texatlas( const c_texatlas& ) = delete;
-		c_texatlas& operator=( const c_texatlas& ) = delete;
+				// blocks past the previous upload are always dirty, the GPU copy there is stale
+				if ( block >= known || blocks[ block ] != hash )
+				{
+					blocks[ block ] = hash;
+					dirty_first = min( dirty_first, block );
+					dirty_last = block + 1;
+				}
+			}
 
-		[[nodiscard]] bool create( const point_t& dimensions ) noexcept
-		{
-			if ( !daisy_t::s_device )
+			if ( dirty_first >= dirty_last )
 				return false;
 
-			this->m_dimensions = dimensions;
-			this->m_cursor = point_t { 0.f, 0.f };
-			this->m_max_height = 0.f;
-
-			D3D11_TEXTURE2D_DESC tex_desc = {};
-			tex_desc.Width = static_cast< UINT >( dimensions.x );
-			tex_desc.Height = static_cast< UINT >( dimensions.y );
-			tex_desc.MipLevels = 1;
-			tex_desc.ArraySize = 1;
-			tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-			tex_desc.SampleDesc.Count = 1;
-			tex_desc.Usage = D3D11_USAGE_DYNAMIC;
-			tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			tex_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			first = static_cast< uint32_t >( dirty_first * daisy_retained_block );
+			last = static_cast< uint32_t >( min( dirty_last * daisy_retained_block, size ) );
 
-			HRESULT hr = daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &this->m_texture );
-			if ( FAILED( hr ) )
-				return false;
+			return true;
+		}
 
-			D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
-			srv_desc.Format = tex_desc.Format;
-			srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-			srv_desc.Texture2D.MipLevels = 1;
+		// Vertex/index buffers are DEFAULT in retained mode so dirty spans can go through UpdateSubresource
+		bool create_geometry_buffer( const uint32_t byte_width, const UINT bind_flags, ID3D11Buffer** buffer ) const noexcept
+		{
+			if ( !this->m_retained || this->m_ring_upload )
+				return create_dynamic_buffer( byte_width, bind_flags, buffer );
 
-			hr = daisy_t::s_device->CreateShaderResourceView( this->m_texture, &srv_desc, &this->m_texture_srv );
-			if ( FAILED( hr ) )
-				return false;
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = byte_width;
+			desc.Usage = D3D11_USAGE_DEFAULT;
+			desc.BindFlags = bind_flags;
 
-			return true;
+			return SUCCEEDED( daisy_t::s_device->CreateBuffer( &desc, nullptr, buffer ) );
 		}
 
-		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		void release_geometry_buffers( ) noexcept
 		{
-			if ( !pre_reset )
-				return this->create( this->m_dimensions );
-			else
+			if ( this->m_vertex_buffer )
 			{
-				if ( m_texture_srv )
-				{
-					m_texture_srv->Release( );
-					m_texture_srv = nullptr;
-				}
-				if ( m_texture )
-				{
-					m_texture->Release( );
-					m_texture = nullptr;
-				}
+				this->m_vertex_buffer->Release( );
+				this->m_vertex_buffer = nullptr;
 			}
-			return true;
-		}
 
-		bool append( const uint32_t uuid, const point_t& dimensions, uint8_t* tex_data, uint32_t tex_size ) noexcept
-		{
-			if ( !tex_data || !tex_size )
-				return false;
-
-			if ( this->m_cursor.x + dimensions.x > this->m_dimensions.x )
+			if ( this->m_index_buffer )
 			{
-				this->m_cursor.y += this->m_max_height;
-				this->m_cursor.x = this->m_max_height = 0.f;
+				this->m_index_buffer->Release( );
+				this->m_index_buffer = nullptr;
 			}
+		}
 
-			if ( this->m_cursor.y + dimensions.y > this->m_dimensions.y )
-				return false;
-
-			if ( this->m_max_height < dimensions.y )
-				this->m_max_height = dimensions.y;
+		// Uploads the CALL_TRI drawcalls from first onwards that fit into the rings in one go
+		// - appends with D3D11_MAP_WRITE_NO_OVERWRITE and only DISCARDs when the rings wrap
+		// - ring_vertex/ring_index receive where vertex_idx/index_idx landed, returns the first drawcall not uploaded
+		size_t upload_ring_chunk( size_t first, uint32_t vertex_idx, uint32_t index_idx, uint32_t& ring_vertex, uint32_t& ring_index ) noexcept
+		{
+			const auto& first_call = this->m_drawcalls[ first ].m_tri;
 
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			HRESULT hr = daisy_t::s_context->Map( this->m_texture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped );
-			if ( FAILED( hr ) )
-				return false;
+			// a single drawcall bigger than the ring is the only case that still reallocates, besides
+			// replacing the DEFAULT buffers retained mode left behind
+			const bool grow = first_call.m_vertices > this->m_vtx_ring.m_capacity || first_call.m_indices > this->m_idx_ring.m_capacity;
 
-			for ( int y = 0; y < dimensions.y; ++y )
+			if ( grow || this->m_default_buffers )
 			{
-				for ( int x = 0; x < dimensions.x; ++x )
-				{
-					const uint8_t* source_pixel = tex_data + static_cast< uint32_t >( dimensions.x ) * 4 * y + x * 4;
-
-					if ( static_cast< uint32_t >( dimensions.x ) * 4 * y + x * 4 > tex_size )
-						return false;
+				const uint32_t vertices = grow ? max( this->m_vtx_ring.m_capacity * 2, first_call.m_vertices ) : this->m_vtx_ring.m_capacity;
+				const uint32_t indices = grow ? max( this->m_idx_ring.m_capacity * 2, first_call.m_indices ) : this->m_idx_ring.m_capacity;
 
-					uint8_t* destination_pixel = static_cast< uint8_t* >( mapped.pData ) +
-						mapped.RowPitch * ( static_cast< uint32_t >( this->m_cursor.y ) + y ) +
-						( static_cast< uint32_t >( this->m_cursor.x ) + x ) * 4;
+				this->release_geometry_buffers( );
 
-					// RGBA format
-					destination_pixel[ 0 ] = source_pixel[ 0 ];
-					destination_pixel[ 1 ] = source_pixel[ 1 ];
-					destination_pixel[ 2 ] = source_pixel[ 2 ];
-					destination_pixel[ 3 ] = source_pixel[ 3 ];
+				if ( !create_dynamic_buffer( vertices * sizeof( daisy_vtx_t ), D3D11_BIND_VERTEX_BUFFER, &this->m_vertex_buffer ) ||
+					!create_dynamic_buffer( indices * sizeof( daisy_idx_t ), D3D11_BIND_INDEX_BUFFER, &this->m_index_buffer ) )
+				{
+					// both stay null, the next flush retries here and the non-ring path rebuilds them
+					this->release_geometry_buffers( );
+					this->m_vtx_ring = this->m_idx_ring = ringbuffer_t {};
+					this->m_realloc_vtx = this->m_realloc_idx = true;
+					return this->m_drawcalls.size( );
 				}
+
+				this->m_vtx_ring = ringbuffer_t { vertices, vertices };
+				this->m_idx_ring = ringbuffer_t { indices, indices };
+				this->m_default_buffers = false;
+				this->bind_pipeline( daisy_call_kind::CALL_TRI );
 			}
 
-			daisy_t::s_context->Unmap( this->m_texture, 0 );
+			// wrap both rings together when the first drawcall doesn't fit behind the cursors
+			const bool wrap = this->m_vtx_ring.m_cursor + first_call.m_vertices > this->m_vtx_ring.m_capacity ||
+				this->m_idx_ring.m_cursor + first_call.m_indices > this->m_idx_ring.m_capacity;
 
-			auto start_uv = point_t { this->m_cursor.x / this->m_dimensions.x, this->m_cursor.y / this->m_dimensions.y };
-			auto end_uv = point_t { start_uv.x + dimensions.x / this->m_dimensions.x, start_uv.y + dimensions.y / this->m_dimensions.y };
-			this->m_coords[ uuid ] = uv_t { start_uv.x, start_uv.y, end_uv.x, end_uv.y };
+			if ( wrap )
+				this->m_vtx_ring.m_cursor = this->m_idx_ring.m_cursor = 0;
 
-			this->m_cursor.x += dimensions.x;
+			uint32_t vertices = 0, indices = 0;
+			size_t last = first;
 
-			return true;
-		}
+			for ( ; last < this->m_drawcalls.size( ); last++ )
+			{
+				const auto& cmd = this->m_drawcalls[ last ];
+				if ( cmd.m_kind != daisy_call_kind::CALL_TRI )
+					continue;
 
-		const uv_t& coords( uint32_t uuid ) const noexcept
-		{
-			if ( this->m_coords.find( uuid ) != this->m_coords.end( ) )
-				return this->m_coords.at( uuid );
+				if ( this->m_vtx_ring.m_cursor + vertices + cmd.m_tri.m_vertices > this->m_vtx_ring.m_capacity ||
+					this->m_idx_ring.m_cursor + indices + cmd.m_tri.m_indices > this->m_idx_ring.m_capacity )
+					break;
 
-			static uv_t null_uv { 0.f, 0.f, 0.f, 0.f };
-			return null_uv;
-		}
+				vertices += cmd.m_tri.m_vertices;
+				indices += cmd.m_tri.m_indices;
+			}
 
-		ID3D11ShaderResourceView* texture_srv( ) const noexcept
-		{
-			return this->m_texture_srv;
-		}
-	};
+			const D3D11_MAP map_type = wrap ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
 
-	// Render queue class - continues in next part due to length
-	class c_renderqueue : public c_daisy_resettable_object
-	{
-	private:
-		ID3D11Buffer* m_vertex_buffer = nullptr;
-		ID3D11Buffer* m_index_buffer = nullptr;
-		ID3D11Buffer* m_constant_buffer = nullptr;
+			D3D11_MAPPED_SUBRESOURCE mapped_vtx;
+			if ( SUCCEEDED( daisy_t::s_context->Map( this->m_vertex_buffer, 0, map_type, 0, &mapped_vtx ) ) )
+			{
+				memcpy( reinterpret_cast< uint8_t* >( mapped_vtx.pData ) + sizeof( daisy_vtx_t ) * this->m_vtx_ring.m_cursor,
+					this->m_vtxs.m_data.get( ) + sizeof( daisy_vtx_t ) * vertex_idx, sizeof( daisy_vtx_t ) * vertices );
+				daisy_t::s_context->Unmap( this->m_vertex_buffer, 0 );
+			}
 
-		renderbuffer_t m_vtxs, m_idxs;
-		stl::vector<daisy_drawcall_t> m_drawcalls;
+			D3D11_MAPPED_SUBRESOURCE mapped_idx;
+			if ( SUCCEEDED( daisy_t::s_context->Map( this->m_index_buffer, 0, map_type, 0, &mapped_idx ) ) )
+			{
+				memcpy( reinterpret_cast< uint8_t* >( mapped_idx.pData ) + sizeof( daisy_idx_t ) * this->m_idx_ring.m_cursor,
+					this->m_idxs.m_data.get( ) + sizeof( daisy_idx_t ) * index_idx, sizeof( daisy_idx_t ) * indices );
+				daisy_t::s_context->Unmap( this->m_index_buffer, 0 );
+			}
 
-		bool m_update;
-		bool m_realloc_vtx, m_realloc_idx;
+			ring_vertex = this->m_vtx_ring.m_cursor;
+			ring_index = this->m_idx_ring.m_cursor;
 
-	private:
-		void ensure_buffers_capacity( const uint32_t vertices_to_add, const uint32_t indices_to_add ) noexcept
+			this->m_vtx_ring.m_cursor += vertices;
+			this->m_idx_ring.m_cursor += indices;
+
+			return last;
+		}
+
+		// CPU side buffers only, all a recording-only queue (c_parallel_queue) needs
+		[[nodiscard]] bool create_local_buffers( const uint32_t max_verts, const uint32_t max_indices, const uint32_t max_rects, const uint32_t max_glyphs ) noexcept
 		{
-			if ( this->m_vtxs.m_size + vertices_to_add > this->m_vtxs.m_capacity )
+			if ( !this->m_vtxs.m_data.get( ) )
 			{
-				while ( this->m_vtxs.m_size + vertices_to_add > this->m_vtxs.m_capacity )
-					this->m_vtxs.m_capacity = this->m_vtxs.m_capacity * 2;
+				this->m_vtxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_vtx_t ) * max_verts );
+				this->m_vtxs.m_capacity = max_verts;
+				this->m_vtxs.m_size = 0;
+			}
 
-				auto new_vtx = stl::make_unique<uint8_t[ ]>( this->m_vtxs.m_capacity * sizeof( daisy_vtx_t ) );
+			if ( !this->m_idxs.m_data )
+			{
+				this->m_idxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_idx_t ) * max_indices );
+				this->m_idxs.m_capacity = max_indices;
+				this->m_idxs.m_size = 0;
+			}
 
-				if ( new_vtx )
-				{
-					memcpy( new_vtx.get( ), this->m_vtxs.m_data.get( ), this->m_vtxs.m_size * sizeof( daisy_vtx_t ) );
-					this->m_realloc_vtx = true;
-					this->m_vtxs.m_data.swap( new_vtx );
-				}
+			if ( !this->m_rects.m_data )
+			{
+				this->m_rects.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_rect_t ) * max_rects );
+				this->m_rects.m_capacity = max_rects;
+				this->m_rects.m_size = 0;
 			}
 
-			if ( this->m_idxs.m_size + indices_to_add > this->m_idxs.m_capacity )
+			if ( !this->m_glyphs.m_data )
 			{
-				while ( this->m_idxs.m_size + indices_to_add > this->m_idxs.m_capacity )
-					this->m_idxs.m_capacity = this->m_idxs.m_capacity * 2;
+				this->m_glyphs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_glyph_instance_t ) * max_glyphs );
+				this->m_glyphs.m_capacity = max_glyphs;
+				this->m_glyphs.m_size = 0;
+			}
 
-				auto new_idx = stl::make_unique<uint8_t[ ]>( this->m_idxs.m_capacity * sizeof( uint16_t ) );
+			if ( !this->m_vtxs.m_data || !this->m_idxs.m_data || !this->m_rects.m_data || !this->m_glyphs.m_data )
+				return false;
 
-				if ( new_idx )
-				{
-					memcpy( new_idx.get( ), this->m_idxs.m_data.get( ), this->m_idxs.m_size * sizeof( uint16_t ) );
-					this->m_realloc_idx = true;
-					this->m_idxs.m_data.swap( new_idx );
-				}
-			}
+			return true;
 		}
 
-		uint32_t begin_batch( ID3D11ShaderResourceView* texture_srv = nullptr ) const noexcept
+		// Holds s_lazy_fonts and every lazy font for the scope of a flush, a recording thread only waits on it
+		// when it rasterizes a glyph; always list before fonts, rasterize_glyph takes a single font lock
+		struct lazy_fonts_lock_t
 		{
-			uint32_t additional = 0;
+			lazy_fonts_lock_t( ) noexcept
+			{
+				daisy_t::s_lazy_fonts_lock.lock( );
 
-			if ( !this->m_drawcalls.empty( ) )
+				for ( auto* font : daisy_t::s_lazy_fonts )
+					font->m_lazy_lock.lock( );
+			}
+
+			~lazy_fonts_lock_t( ) noexcept
 			{
-				auto& last_call = this->m_drawcalls.back( );
-				if ( last_call.m_kind == daisy_call_kind::CALL_TRI && last_call.m_tri.m_texture_srv == texture_srv )
-				{
-					additional = last_call.m_tri.m_vertices;
-				}
+				for ( auto* font : daisy_t::s_lazy_fonts )
+					font->m_lazy_lock.unlock( );
+
+				daisy_t::s_lazy_fonts_lock.unlock( );
 			}
 
-			return additional;
+			lazy_fonts_lock_t( const lazy_fonts_lock_t& ) = delete;
+			lazy_fonts_lock_t& operator=( const lazy_fonts_lock_t& ) = delete;
+		};
+
+		// The GPU copies no longer match what retained mode last uploaded
+		void forget_uploads( ) noexcept
+		{
+			this->m_vtx_blocks.clear( );
+			this->m_idx_blocks.clear( );
+			this->m_rect_blocks.clear( );
+			this->m_glyph_blocks.clear( );
+			this->m_uploaded_viewport[ 0 ] = this->m_uploaded_viewport[ 1 ] = -1.f;
 		}
 
-		void end_batch( uint32_t additional_indices, uint32_t vertices, uint32_t indices, uint32_t primitives, ID3D11ShaderResourceView* texture_srv = nullptr )
+		void flush_backend( ) noexcept
 		{
-			if ( !additional_indices )
-			{
-				daisy_drawcall_t d {};
-				d.m_kind = daisy_call_kind::CALL_TRI;
-				d.m_tri.m_indices = indices;
-				d.m_tri.m_vertices = vertices;
-				d.m_tri.m_texture_srv = texture_srv;
-				d.m_tri.m_primitives = primitives;
+			uint32_t vertex_idx { 0 }, index_idx { 0 }, instance_idx { 0 }, glyph_idx { 0 };
 
-				this->m_drawcalls.push_back( stl::move( d ) );
-			}
-			else
+			for ( const auto& cmd : this->m_drawcalls )
 			{
-				auto& last_call = this->m_drawcalls.back( );
+				switch ( cmd.m_kind )
+				{
+				case daisy_call_kind::CALL_TRI:
+					this->m_backend->draw_indexed( cmd.m_tri.m_texture_srv, cmd.m_tri.m_indices, index_idx, vertex_idx );
 
-				last_call.m_tri.m_vertices += vertices;
-				last_call.m_tri.m_indices += indices;
-				last_call.m_tri.m_primitives += primitives;
-			}
+					vertex_idx += cmd.m_tri.m_vertices;
+					index_idx += cmd.m_tri.m_indices;
+					break;
+				case daisy_call_kind::CALL_RECT:
+					this->m_backend->draw_rects( cmd.m_rect.m_texture_srv, cmd.m_rect.m_instances, instance_idx );
 
-			this->m_update = true;
+					instance_idx += cmd.m_rect.m_instances;
+					break;
+				case daisy_call_kind::CALL_SHAPE:
+					this->m_backend->draw_shapes( cmd.m_rect.m_instances, instance_idx );
+
+					instance_idx += cmd.m_rect.m_instances;
+					break;
+				case daisy_call_kind::CALL_GLYPH:
+					this->m_backend->draw_glyphs( *cmd.m_glyph.m_font, cmd.m_glyph.m_instances, glyph_idx );
+
+					glyph_idx += cmd.m_glyph.m_instances;
+					break;
+				case daisy_call_kind::CALL_SCISSOR:
+					this->m_backend->scissor( cmd.m_scissor.m_position, cmd.m_scissor.m_size );
+					break;
+				default:
+					break;
+				}
+			}
 		}
 
 	public:
 		c_renderqueue( ) noexcept
-			: m_update( true ), m_realloc_vtx( false ), m_realloc_idx( false )
+			: m_uploaded_viewport { -1.f, -1.f }, m_update( true ), m_realloc_vtx( false ), m_realloc_idx( false ), m_realloc_rect( false ), m_realloc_glyph( false ),
+			m_instanced_rects( false ), m_instanced_glyphs( false ), m_texture_array( false ),
+			m_ring_upload( false ), m_retained( false ), m_default_buffers( false ), m_unchanged( false ), m_text_style( 0 ),
+			m_recording_run( false ), m_circle_tolerance( 0.25f )
 		{
 		}
 
@@ -964,44 +5643,43 @@ float4 main(PS_INPUT input) : SV_TARGET
 				m_index_buffer->Release( );
 			if ( m_constant_buffer )
 				m_constant_buffer->Release( );
+			if ( m_instance_buffer )
+				m_instance_buffer->Release( );
+			if ( m_glyph_instance_buffer )
+				m_glyph_instance_buffer->Release( );
 		}
 
 		c_renderqueue( const c_renderqueue& ) = delete;
 		c_renderqueue& operator=( const c_renderqueue& ) = delete;
 
-		[[nodiscard]] bool create( const uint32_t max_verts = 32767, const uint32_t max_indices = 65535 ) noexcept
+		[[nodiscard]] bool create( const uint32_t max_verts = 32767, const uint32_t max_indices = 65535, const uint32_t max_rects = 4096, const uint32_t max_glyphs = 8192 ) noexcept
 		{
-			if ( !daisy_t::s_device )
+			if ( !daisy_t::s_device && !this->m_backend )
 				return false;
 
 			// Create vertex buffer
-			if ( !this->m_vertex_buffer )
+			if ( daisy_t::s_device && !this->m_vertex_buffer )
 			{
-				D3D11_BUFFER_DESC desc = {};
-				desc.ByteWidth = sizeof( daisy_vtx_t ) * max_verts;
-				desc.Usage = D3D11_USAGE_DYNAMIC;
-				desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-				desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-				if ( FAILED( daisy_t::s_device->CreateBuffer( &desc, nullptr, &this->m_vertex_buffer ) ) )
+				if ( !this->create_geometry_buffer( sizeof( daisy_vtx_t ) * max_verts, D3D11_BIND_VERTEX_BUFFER, &this->m_vertex_buffer ) )
 					return false;
+
+				// cursor at the end so the first ring upload DISCARDs
+				this->m_vtx_ring = ringbuffer_t { max_verts, max_verts };
 			}
 
 			// Create index buffer
-			if ( !this->m_index_buffer )
+			if ( daisy_t::s_device && !this->m_index_buffer )
 			{
-				D3D11_BUFFER_DESC desc = {};
-				desc.ByteWidth = sizeof( uint16_t ) * max_indices;
-				desc.Usage = D3D11_USAGE_DYNAMIC;
-				desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-				desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-				if ( FAILED( daisy_t::s_device->CreateBuffer( &desc, nullptr, &this->m_index_buffer ) ) )
+				if ( !this->create_geometry_buffer( sizeof( daisy_idx_t ) * max_indices, D3D11_BIND_INDEX_BUFFER, &this->m_index_buffer ) )
 					return false;
+
+				this->m_idx_ring = ringbuffer_t { max_indices, max_indices };
+				this->m_default_buffers = this->m_retained && !this->m_ring_upload;
+				this->forget_uploads( );
 			}
 
 			// Create constant buffer for viewport
-			if ( !this->m_constant_buffer )
+			if ( daisy_t::s_device && !this->m_constant_buffer )
 			{
 				D3D11_BUFFER_DESC desc = {};
 				desc.ByteWidth = sizeof( float ) * 4; // ViewportSize + padding
@@ -1013,41 +5691,324 @@ float4 main(PS_INPUT input) : SV_TARGET
 					return false;
 			}
 
-			// Create local buffers
-			if ( !this->m_vtxs.m_data.get( ) )
+			// Create rect instance buffer
+			if ( daisy_t::s_device && !this->m_instance_buffer )
 			{
-				this->m_vtxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_vtx_t ) * max_verts );
-				this->m_vtxs.m_capacity = max_verts;
-				this->m_vtxs.m_size = 0;
+				if ( !create_dynamic_buffer( sizeof( daisy_rect_t ) * max_rects, D3D11_BIND_VERTEX_BUFFER, &this->m_instance_buffer ) )
+					return false;
 			}
 
-			if ( !this->m_idxs.m_data )
+			// Create glyph instance buffer
+			if ( daisy_t::s_device && !this->m_glyph_instance_buffer )
 			{
-				this->m_idxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( uint16_t ) * max_indices );
-				this->m_idxs.m_capacity = max_indices;
-				this->m_idxs.m_size = 0;
+				if ( !create_dynamic_buffer( sizeof( daisy_glyph_instance_t ) * max_glyphs, D3D11_BIND_VERTEX_BUFFER, &this->m_glyph_instance_buffer ) )
+					return false;
 			}
 
-			if ( !this->m_vtxs.m_data || !this->m_idxs.m_data )
-				return false;
+			// Create local buffers
+			return this->create_local_buffers( max_verts, max_indices, max_rects, max_glyphs );
+		}
 
-			return true;
+		// Routes update( )/flush( ) through a backend instead of daisy_t::s_context, pass nullptr to go back to D3D11
+		// - attach before create( ) to use the queue without a device
+		void set_backend( c_daisy_backend* backend ) noexcept
+		{
+			this->m_backend = backend;
+			this->m_update = true;
+		}
+
+		c_daisy_backend* backend( ) const noexcept
+		{
+			return this->m_backend;
+		}
+
+		// Emits push_gradient_rectangle/push_filled_rectangle as one daisy_rect_t instance each
+		// instead of 4 vertices and 6 indices, drawn with DrawIndexedInstanced
+		void set_instanced_rects( bool enabled ) noexcept
+		{
+			this->m_instanced_rects = enabled;
+		}
+
+		bool instanced_rects( ) const noexcept
+		{
+			return this->m_instanced_rects;
+		}
+
+		// Emits push_text glyphs as one daisy_glyph_instance_t each; the quad is built in the glyph
+		// vertex shader from the font's glyph table
+		void set_instanced_glyphs( bool enabled ) noexcept
+		{
+			this->m_instanced_glyphs = enabled;
+		}
+
+		bool instanced_glyphs( ) const noexcept
+		{
+			return this->m_instanced_glyphs;
+		}
+
+		// Draws textures registered with daisy_register_texture (and the white texture) from the shared
+		// texture array, so interleaved fonts/atlases/untextured geometry merge into the same drawcall
+		// - only applies to the vertex path, instanced rects/glyphs keep binding their own texture
+		void set_texture_array( bool enabled ) noexcept
+		{
+			this->m_texture_array = enabled;
+		}
+
+		bool texture_array( ) const noexcept
+		{
+			return this->m_texture_array;
+		}
+
+		// Style (from daisy_add_text_style) of the FONT_SDF text pushed after this, 0 is plain text
+		// - carried in the vertices, so it takes the vertex path and needs the full vertex layout
+		void set_text_style( uint32_t style ) noexcept
+		{
+			this->m_text_style = style < daisy_max_text_styles ? style : 0;
+		}
+
+		uint32_t text_style( ) const noexcept
+		{
+			return this->m_text_style;
+		}
+
+		// Largest distance in pixels between a tessellated circle edge and the true one, circles, rings, arcs and pies
+		// pushed without a segment count get as many segments as that takes
+		void set_circle_tolerance( float tolerance ) noexcept
+		{
+			this->m_circle_tolerance = tolerance > 0.f ? tolerance : 0.25f;
+		}
+
+		float circle_tolerance( ) const noexcept
+		{
+			return this->m_circle_tolerance;
+		}
+
+		// Keeps the quads of up to runs push_text calls (by font, text, color, alignment, size and text style) and
+		// copies them with a translation when the same text is pushed again, least recently used runs are evicted
+		// - only the vertex path is cached, instanced glyphs keep doing their own layout
+		// - runs of a font go stale when it is recreated or reset and simply miss, 0 turns the cache off
+		void set_text_cache( uint32_t runs ) noexcept
+		{
+			this->m_text_cache.set_capacity( runs );
+
+			if ( runs && !this->m_run_vtxs.m_data )
+			{
+				this->m_run_vtxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_vtx_t ) * 256 );
+				this->m_run_vtxs.m_capacity = 256;
+				this->m_run_idxs.m_data = stl::make_unique<uint8_t[ ]>( sizeof( daisy_idx_t ) * 384 );
+				this->m_run_idxs.m_capacity = 384;
+			}
+		}
+
+		const c_text_cache& text_cache( ) const noexcept
+		{
+			return this->m_text_cache;
+		}
+
+		// Streams vertices/indices through the GPU buffers as rings during flush( ) instead of re-uploading the
+		// whole frame with DISCARD in update( ); chunks append with NO_OVERWRITE and frames bigger than the
+		// GPU buffers are drawn in several chunks rather than reallocating them
+		// - every flush( ) uploads again, combine with submit( ) to draw parts of a frame while recording the rest
+		void set_ring_upload( bool enabled ) noexcept
+		{
+			this->m_ring_upload = enabled;
+			this->m_update = true;
+			this->forget_uploads( );
+		}
+
+		bool ring_upload( ) const noexcept
+		{
+			return this->m_ring_upload;
+		}
+
+		// Retained mode: update( ) hashes what was recorded in 4 KiB blocks and only uploads the span that changed
+		// since the last upload, an overlay that is cleared and re-recorded identically uploads nothing
+		// - vertices/indices go through DEFAULT buffers and UpdateSubresource; ring mode keeps streaming them
+		// - a queue that isn't cleared is never re-uploaded at all, flush( ) just draws it again
+		void set_retained( bool enabled ) noexcept
+		{
+			this->m_retained = enabled;
+			this->m_update = true;
+			this->forget_uploads( );
+		}
+
+		bool retained( ) const noexcept
+		{
+			return this->m_retained;
+		}
+
+		// Whether the last update( ) found nothing to upload
+		bool unchanged( ) const noexcept
+		{
+			return this->m_unchanged;
 		}
 
 		void clear( ) noexcept
 		{
 			this->m_vtxs.m_size = 0;
 			this->m_idxs.m_size = 0;
+			this->m_rects.m_size = 0;
+			this->m_glyphs.m_size = 0;
+
+			if ( !this->m_drawcalls.empty( ) )
+				this->m_drawcalls.clear( );
+
+			this->m_update = true;
+		}
+
+		// Appends everything other recorded behind what this queue recorded, as if it had been pushed here
+		// - the boundary drawcalls merge when they share kind and texture, indices of the merged call get rebased
+		void append( const c_renderqueue& other ) noexcept
+		{
+			if ( other.m_drawcalls.empty( ) )
+				return;
+
+			this->ensure_buffers_capacity( other.m_vtxs.m_size, other.m_idxs.m_size );
+			this->ensure_rects_capacity( other.m_rects.m_size );
+			this->ensure_glyphs_capacity( other.m_glyphs.m_size );
+
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( this->m_idxs.m_data.get( ) ) + this->m_idxs.m_size;
+
+			memcpy( this->m_vtxs.m_data.get( ) + sizeof( daisy_vtx_t ) * this->m_vtxs.m_size, other.m_vtxs.m_data.get( ), sizeof( daisy_vtx_t ) * other.m_vtxs.m_size );
+			memcpy( idx, other.m_idxs.m_data.get( ), sizeof( daisy_idx_t ) * other.m_idxs.m_size );
+			memcpy( this->m_rects.m_data.get( ) + sizeof( daisy_rect_t ) * this->m_rects.m_size, other.m_rects.m_data.get( ), sizeof( daisy_rect_t ) * other.m_rects.m_size );
+			memcpy( this->m_glyphs.m_data.get( ) + sizeof( daisy_glyph_instance_t ) * this->m_glyphs.m_size, other.m_glyphs.m_data.get( ), sizeof( daisy_glyph_instance_t ) * other.m_glyphs.m_size );
+
+			this->m_vtxs.m_size += other.m_vtxs.m_size;
+			this->m_idxs.m_size += other.m_idxs.m_size;
+			this->m_rects.m_size += other.m_rects.m_size;
+			this->m_glyphs.m_size += other.m_glyphs.m_size;
+			this->m_update = true;
+
+			auto first = other.m_drawcalls.begin( );
+
+			if ( !this->m_drawcalls.empty( ) && this->m_drawcalls.back( ).m_kind == first->m_kind )
+			{
+				auto& last_call = this->m_drawcalls.back( );
+
+				switch ( first->m_kind )
+				{
+				case daisy_call_kind::CALL_TRI:
+					if ( last_call.m_tri.m_texture_srv == first->m_tri.m_texture_srv &&
+						static_cast< uint64_t >( last_call.m_tri.m_vertices ) + first->m_tri.m_vertices <= daisy_max_batch_vertices )
+					{
+						// indices are relative to the drawcall's first vertex, which is now last_call's
+						for ( uint32_t i = 0; i < first->m_tri.m_indices; i++ )
+							idx[ i ] = static_cast< daisy_idx_t >( idx[ i ] + last_call.m_tri.m_vertices );
+
+						last_call.m_tri.m_vertices += first->m_tri.m_vertices;
+						last_call.m_tri.m_indices += first->m_tri.m_indices;
+						last_call.m_tri.m_primitives += first->m_tri.m_primitives;
+						++first;
+					}
+					break;
+				case daisy_call_kind::CALL_RECT:
+				case daisy_call_kind::CALL_SHAPE:
+					if ( last_call.m_rect.m_texture_srv == first->m_rect.m_texture_srv )
+					{
+						last_call.m_rect.m_instances += first->m_rect.m_instances;
+						++first;
+					}
+					break;
+				case daisy_call_kind::CALL_GLYPH:
+					if ( last_call.m_glyph.m_font == first->m_glyph.m_font && last_call.m_glyph.m_page == first->m_glyph.m_page )
+					{
+						last_call.m_glyph.m_instances += first->m_glyph.m_instances;
+						++first;
+					}
+					break;
+				default:
+					break;
+				}
+			}
+
+			this->m_drawcalls.insert( this->m_drawcalls.end( ), first, other.m_drawcalls.end( ) );
+		}
+
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			if ( !pre_reset )
+				return this->create( this->m_vtxs.m_capacity, this->m_idxs.m_capacity, this->m_rects.m_capacity, this->m_glyphs.m_capacity );
+			else
+			{
+				if ( this->m_vertex_buffer )
+				{
+					this->m_vertex_buffer->Release( );
+					this->m_vertex_buffer = nullptr;
+				}
+
+				if ( this->m_index_buffer )
+				{
+					this->m_index_buffer->Release( );
+					this->m_index_buffer = nullptr;
+				}
+
+				if ( this->m_constant_buffer )
+				{
+					this->m_constant_buffer->Release( );
+					this->m_constant_buffer = nullptr;
+				}
+
+				if ( this->m_instance_buffer )
+				{
+					this->m_instance_buffer->Release( );
+					this->m_instance_buffer = nullptr;
+				}
+
+				if ( this->m_glyph_instance_buffer )
+				{
+					this->m_glyph_instance_buffer->Release( );
+					this->m_glyph_instance_buffer = nullptr;
+				}
+
+				this->forget_uploads( );
+			}
+
+			return true;
+		}
+
+		void update( ) noexcept
+		{
+			uint32_t first, last;
+
+			if ( this->m_backend )
+			{
+				if ( this->m_retained )
+				{
+					// non-short-circuiting so every stream's hashes stay current
+					const bool dirty = dirty_span( this->m_vtxs, sizeof( daisy_vtx_t ), this->m_vtx_blocks, first, last ) |
+						dirty_span( this->m_idxs, sizeof( daisy_idx_t ), this->m_idx_blocks, first, last ) |
+						dirty_span( this->m_rects, sizeof( daisy_rect_t ), this->m_rect_blocks, first, last ) |
+						dirty_span( this->m_glyphs, sizeof( daisy_glyph_instance_t ), this->m_glyph_blocks, first, last );
+
+					this->m_unchanged = !dirty;
+
+					if ( !dirty )
+					{
+						this->m_update = false;
+						return;
+					}
+				}
+
+				if ( this->m_backend->upload( this->m_vtxs, this->m_idxs, this->m_rects, this->m_glyphs ) )
+					this->m_update = false;
+				else
+					this->forget_uploads( );
+
+				return;
+			}
+
+			if ( !daisy_t::s_device || !daisy_t::s_context )
+				return;
 
-			if ( !this->m_drawcalls.empty( ) )
-				this->m_drawcalls.clear( );
-		}
+			// switching retained mode on/off swaps the vertex/index buffers between DEFAULT and DYNAMIC
+			if ( !this->m_ring_upload && this->m_default_buffers != this->m_retained )
+				this->m_realloc_vtx = this->m_realloc_idx = true;
 
-		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
-		{
-			if ( !pre_reset )
-				return this->create( this->m_vtxs.m_capacity, this->m_idxs.m_capacity );
-			else
+			this->m_unchanged = true;
+
+			// Reallocate if needed
+			if ( this->m_realloc_vtx && !this->m_ring_upload )
 			{
 				if ( this->m_vertex_buffer )
 				{
@@ -1055,80 +6016,130 @@ float4 main(PS_INPUT input) : SV_TARGET
 					this->m_vertex_buffer = nullptr;
 				}
 
+				if ( !this->create_geometry_buffer( static_cast< UINT >( this->m_vtxs.m_capacity * sizeof( daisy_vtx_t ) ), D3D11_BIND_VERTEX_BUFFER, &this->m_vertex_buffer ) )
+					return;
+
+				this->m_vtx_ring = ringbuffer_t { this->m_vtxs.m_capacity, this->m_vtxs.m_capacity };
+				this->m_vtx_blocks.clear( );
+				this->m_realloc_vtx = false;
+			}
+
+			if ( this->m_realloc_idx && !this->m_ring_upload )
+			{
 				if ( this->m_index_buffer )
 				{
 					this->m_index_buffer->Release( );
 					this->m_index_buffer = nullptr;
 				}
 
-				if ( this->m_constant_buffer )
-				{
-					this->m_constant_buffer->Release( );
-					this->m_constant_buffer = nullptr;
-				}
-			}
+				if ( !this->create_geometry_buffer( static_cast< UINT >( this->m_idxs.m_capacity * sizeof( daisy_idx_t ) ), D3D11_BIND_INDEX_BUFFER, &this->m_index_buffer ) )
+					return;
 
-			return true;
-		}
+				this->m_idx_ring = ringbuffer_t { this->m_idxs.m_capacity, this->m_idxs.m_capacity };
+				this->m_idx_blocks.clear( );
+				this->m_realloc_idx = false;
+			}
 
-		void update( ) noexcept
-		{
-			if ( !daisy_t::s_device || !daisy_t::s_context )
-				return;
+			if ( !this->m_ring_upload )
+				this->m_default_buffers = this->m_retained;
 
-			// Reallocate if needed
-			if ( this->m_realloc_vtx )
+			if ( this->m_realloc_rect )
 			{
-				this->m_vertex_buffer->Release( );
+				this->m_instance_buffer->Release( );
+				this->m_instance_buffer = nullptr;
 
-				D3D11_BUFFER_DESC desc = {};
-				desc.ByteWidth = static_cast< UINT >( this->m_vtxs.m_capacity * sizeof( daisy_vtx_t ) );
-				desc.Usage = D3D11_USAGE_DYNAMIC;
-				desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-				desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+				if ( !create_dynamic_buffer( static_cast< UINT >( this->m_rects.m_capacity * sizeof( daisy_rect_t ) ), D3D11_BIND_VERTEX_BUFFER, &this->m_instance_buffer ) )
+					return;
+
+				this->m_rect_blocks.clear( );
+				this->m_realloc_rect = false;
+			}
+
+			if ( this->m_realloc_glyph )
+			{
+				this->m_glyph_instance_buffer->Release( );
+				this->m_glyph_instance_buffer = nullptr;
 
-				if ( FAILED( daisy_t::s_device->CreateBuffer( &desc, nullptr, &this->m_vertex_buffer ) ) )
+				if ( !create_dynamic_buffer( static_cast< UINT >( this->m_glyphs.m_capacity * sizeof( daisy_glyph_instance_t ) ), D3D11_BIND_VERTEX_BUFFER, &this->m_glyph_instance_buffer ) )
 					return;
 
-				this->m_realloc_vtx = false;
+				this->m_glyph_blocks.clear( );
+				this->m_realloc_glyph = false;
 			}
 
-			if ( this->m_realloc_idx )
+			// Map and copy vertex/index data, ring uploads happen chunk by chunk in flush( )
+			if ( this->m_ring_upload )
+				this->m_unchanged = false;
+			else if ( this->m_retained )
 			{
-				this->m_index_buffer->Release( );
+				if ( dirty_span( this->m_vtxs, sizeof( daisy_vtx_t ), this->m_vtx_blocks, first, last ) )
+				{
+					const D3D11_BOX box = { first, 0, 0, last, 1, 1 };
+					daisy_t::s_context->UpdateSubresource( this->m_vertex_buffer, 0, &box, this->m_vtxs.m_data.get( ) + first, 0, 0 );
+					this->m_unchanged = false;
+				}
 
-				D3D11_BUFFER_DESC desc = {};
-				desc.ByteWidth = static_cast< UINT >( this->m_idxs.m_capacity * sizeof( uint16_t ) );
-				desc.Usage = D3D11_USAGE_DYNAMIC;
-				desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-				desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+				if ( dirty_span( this->m_idxs, sizeof( daisy_idx_t ), this->m_idx_blocks, first, last ) )
+				{
+					const D3D11_BOX box = { first, 0, 0, last, 1, 1 };
+					daisy_t::s_context->UpdateSubresource( this->m_index_buffer, 0, &box, this->m_idxs.m_data.get( ) + first, 0, 0 );
+					this->m_unchanged = false;
+				}
+			}
+			else
+			{
+				this->m_unchanged = false;
 
-				if ( FAILED( daisy_t::s_device->CreateBuffer( &desc, nullptr, &this->m_index_buffer ) ) )
-					return;
+				D3D11_MAPPED_SUBRESOURCE mapped_vtx;
+				if ( SUCCEEDED( daisy_t::s_context->Map( this->m_vertex_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_vtx ) ) )
+				{
+					memcpy( mapped_vtx.pData, this->m_vtxs.m_data.get( ), sizeof( daisy_vtx_t ) * this->m_vtxs.m_size );
+					daisy_t::s_context->Unmap( this->m_vertex_buffer, 0 );
+				}
 
-				this->m_realloc_idx = false;
+				D3D11_MAPPED_SUBRESOURCE mapped_idx;
+				if ( SUCCEEDED( daisy_t::s_context->Map( this->m_index_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_idx ) ) )
+				{
+					memcpy( mapped_idx.pData, this->m_idxs.m_data.get( ), sizeof( daisy_idx_t ) * this->m_idxs.m_size );
+					daisy_t::s_context->Unmap( this->m_index_buffer, 0 );
+				}
 			}
 
-			// Map and copy vertex data
-			D3D11_MAPPED_SUBRESOURCE mapped_vtx;
-			if ( SUCCEEDED( daisy_t::s_context->Map( this->m_vertex_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_vtx ) ) )
+			// Map and copy rect instance data, DISCARD needs the whole buffer so retained mode only skips unchanged ones
+			if ( this->m_rects.m_size && ( !this->m_retained || dirty_span( this->m_rects, sizeof( daisy_rect_t ), this->m_rect_blocks, first, last ) ) )
 			{
-				memcpy( mapped_vtx.pData, this->m_vtxs.m_data.get( ), sizeof( daisy_vtx_t ) * this->m_vtxs.m_size );
-				daisy_t::s_context->Unmap( this->m_vertex_buffer, 0 );
+				this->m_unchanged = false;
+
+				D3D11_MAPPED_SUBRESOURCE mapped_rects;
+				if ( SUCCEEDED( daisy_t::s_context->Map( this->m_instance_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_rects ) ) )
+				{
+					memcpy( mapped_rects.pData, this->m_rects.m_data.get( ), sizeof( daisy_rect_t ) * this->m_rects.m_size );
+					daisy_t::s_context->Unmap( this->m_instance_buffer, 0 );
+				}
 			}
 
-			// Map and copy index data
-			D3D11_MAPPED_SUBRESOURCE mapped_idx;
-			if ( SUCCEEDED( daisy_t::s_context->Map( this->m_index_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_idx ) ) )
+			// Map and copy glyph instance data
+			if ( this->m_glyphs.m_size && ( !this->m_retained || dirty_span( this->m_glyphs, sizeof( daisy_glyph_instance_t ), this->m_glyph_blocks, first, last ) ) )
 			{
-				memcpy( mapped_idx.pData, this->m_idxs.m_data.get( ), sizeof( uint16_t ) * this->m_idxs.m_size );
-				daisy_t::s_context->Unmap( this->m_index_buffer, 0 );
+				this->m_unchanged = false;
+
+				D3D11_MAPPED_SUBRESOURCE mapped_glyphs;
+				if ( SUCCEEDED( daisy_t::s_context->Map( this->m_glyph_instance_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_glyphs ) ) )
+				{
+					memcpy( mapped_glyphs.pData, this->m_glyphs.m_data.get( ), sizeof( daisy_glyph_instance_t ) * this->m_glyphs.m_size );
+					daisy_t::s_context->Unmap( this->m_glyph_instance_buffer, 0 );
+				}
 			}
 
 			// Update constant buffer with viewport size
+			const bool viewport_changed = this->m_uploaded_viewport[ 0 ] != daisy_t::s_viewport_width || this->m_uploaded_viewport[ 1 ] != daisy_t::s_viewport_height;
+
 			D3D11_MAPPED_SUBRESOURCE mapped_cb;
-			if ( SUCCEEDED( daisy_t::s_context->Map( this->m_constant_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_cb ) ) )
+			if ( ( !this->m_retained || viewport_changed ) && SUCCEEDED( daisy_t::s_context->Map( this->m_constant_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_cb ) ) )
 			{
+				this->m_uploaded_viewport[ 0 ] = daisy_t::s_viewport_width;
+				this->m_uploaded_viewport[ 1 ] = daisy_t::s_viewport_height;
+
 				float* cb_data = ( float* ) mapped_cb.pData;
 				cb_data[ 0 ] = daisy_t::s_viewport_width;
 				cb_data[ 1 ] = daisy_t::s_viewport_height;
@@ -1145,46 +6156,132 @@ float4 main(PS_INPUT input) : SV_TARGET
 			if ( this->m_drawcalls.empty( ) )
 				return;
 
-			if ( this->m_update )
+			const bool ring = this->m_ring_upload && !this->m_backend;
+
+			// glyphs lazy fonts rasterized while recording, their pages and glyph tables stay locked until the
+			// drawcalls reading them are submitted
+			const lazy_fonts_lock_t lazy_lock;
+
+			if ( !this->m_backend )
+			{
+				for ( auto* font : daisy_t::s_lazy_fonts )
+					font->upload_glyphs( );
+			}
+
+			if ( this->m_update || ring )
 				this->update( );
 
+			if ( this->m_backend )
+			{
+				this->flush_backend( );
+				return;
+			}
+
 			// Set up pipeline state
-			UINT stride = sizeof( daisy_vtx_t );
-			UINT offset = 0;
-			daisy_t::s_context->IASetVertexBuffers( 0, 1, &this->m_vertex_buffer, &stride, &offset );
-			daisy_t::s_context->IASetIndexBuffer( this->m_index_buffer, DXGI_FORMAT_R16_UINT, 0 );
-			daisy_t::s_context->IASetInputLayout( daisy_t::s_input_layout );
+			daisy_call_kind pipeline = daisy_call_kind::CALL_TRI;
+			this->bind_pipeline( pipeline );
+
 			daisy_t::s_context->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
 
-			daisy_t::s_context->VSSetShader( daisy_t::s_vertex_shader, nullptr, 0 );
-			daisy_t::s_context->PSSetShader( daisy_t::s_pixel_shader, nullptr, 0 );
+			ID3D11PixelShader* pixel_shader = daisy_t::s_pixel_shader;
+			daisy_t::s_context->PSSetShader( pixel_shader, nullptr, 0 );
 			daisy_t::s_context->VSSetConstantBuffers( 0, 1, &this->m_constant_buffer );
 
 			daisy_t::s_context->PSSetSamplers( 0, 1, &daisy_t::s_sampler_state );
+			daisy_t::s_context->PSSetConstantBuffers( 0, 1, &daisy_t::s_text_style_buffer );
 
 			daisy_t::s_context->OMSetBlendState( daisy_t::s_blend_state, nullptr, 0xffffffff );
 			daisy_t::s_context->RSSetState( daisy_t::s_rasterizer_state );
 			daisy_t::s_context->OMSetDepthStencilState( daisy_t::s_depth_stencil_state, 0 );
 
-			uint32_t vertex_idx { 0 }, index_idx { 0 };
+			uint32_t vertex_idx { 0 }, index_idx { 0 }, instance_idx { 0 }, glyph_idx { 0 };
+
+			// ring mode: [chunk_vertex, chunk_index] of the CPU mirror live at [ring_vertex, ring_index] until chunk_end
+			size_t chunk_end = ring ? 0u : this->m_drawcalls.size( );
+			uint32_t chunk_vertex { 0 }, chunk_index { 0 }, ring_vertex { 0 }, ring_index { 0 };
 
 			for ( size_t i = 0u; i < this->m_drawcalls.size( ); i++ )
 			{
 				const auto& cmd = this->m_drawcalls[ i ];
 
+				if ( cmd.m_kind != pipeline && cmd.m_kind != daisy_call_kind::CALL_SCISSOR )
+				{
+					pipeline = cmd.m_kind;
+					this->bind_pipeline( pipeline );
+				}
+
+				// texture array drawcalls sample a Texture2DArray, FONT_SDF text does the distance test with
+				// bilinear filtering, everything else samples a Texture2D
+				if ( cmd.m_kind != daisy_call_kind::CALL_SCISSOR )
+				{
+					const bool array = cmd.m_kind == daisy_call_kind::CALL_TRI && cmd.m_tri.m_texture_srv &&
+						cmd.m_tri.m_texture_srv == daisy_t::s_texture_array_srv;
+					const bool sdf = cmd.m_kind == daisy_call_kind::CALL_TRI && cmd.m_tri.m_texture_srv && !daisy_t::s_sdf_textures.empty( ) &&
+						daisy_t::s_sdf_textures.count( cmd.m_tri.m_texture_srv );
+
+					ID3D11PixelShader* wanted = array ? daisy_t::s_array_pixel_shader : ( sdf ? daisy_t::s_sdf_pixel_shader : daisy_t::s_pixel_shader );
+					if ( cmd.m_kind == daisy_call_kind::CALL_SHAPE )
+						wanted = daisy_t::s_shape_pixel_shader;
+					if ( wanted != pixel_shader )
+					{
+						if ( ( wanted == daisy_t::s_sdf_pixel_shader ) != ( pixel_shader == daisy_t::s_sdf_pixel_shader ) )
+							daisy_t::s_context->PSSetSamplers( 0, 1, sdf ? &daisy_t::s_linear_sampler_state : &daisy_t::s_sampler_state );
+
+						pixel_shader = wanted;
+						daisy_t::s_context->PSSetShader( pixel_shader, nullptr, 0 );
+					}
+				}
+
 				switch ( cmd.m_kind )
 				{
 				case daisy_call_kind::CALL_TRI:
 				{
+					if ( i >= chunk_end )
+					{
+						chunk_end = this->upload_ring_chunk( i, vertex_idx, index_idx, ring_vertex, ring_index );
+						chunk_vertex = vertex_idx;
+						chunk_index = index_idx;
+
+						if ( !this->m_vertex_buffer || !this->m_index_buffer )
+							return;
+					}
+
 					// Use white texture if no texture is provided
 					ID3D11ShaderResourceView* srv = cmd.m_tri.m_texture_srv ? cmd.m_tri.m_texture_srv : daisy_t::s_white_texture_srv;
 					daisy_t::s_context->PSSetShaderResources( 0, 1, &srv );
-					daisy_t::s_context->DrawIndexed( cmd.m_tri.m_indices, index_idx, vertex_idx );
+					daisy_t::s_context->DrawIndexed( cmd.m_tri.m_indices, index_idx - chunk_index + ring_index, vertex_idx - chunk_vertex + ring_vertex );
 
 					vertex_idx += cmd.m_tri.m_vertices;
 					index_idx += cmd.m_tri.m_indices;
 					break;
 				}
+				case daisy_call_kind::CALL_RECT:
+				{
+					ID3D11ShaderResourceView* srv = cmd.m_rect.m_texture_srv ? cmd.m_rect.m_texture_srv : daisy_t::s_white_texture_srv;
+					daisy_t::s_context->PSSetShaderResources( 0, 1, &srv );
+					daisy_t::s_context->DrawIndexedInstanced( 6, cmd.m_rect.m_instances, 0, 0, instance_idx );
+
+					instance_idx += cmd.m_rect.m_instances;
+					break;
+				}
+				case daisy_call_kind::CALL_SHAPE:
+				{
+					daisy_t::s_context->DrawIndexedInstanced( 6, cmd.m_rect.m_instances, 0, 0, instance_idx );
+
+					instance_idx += cmd.m_rect.m_instances;
+					break;
+				}
+				case daisy_call_kind::CALL_GLYPH:
+				{
+					ID3D11ShaderResourceView* glyph_srv = cmd.m_glyph.m_font->glyph_srv( );
+					ID3D11ShaderResourceView* srv = cmd.m_glyph.m_font->page_srv( cmd.m_glyph.m_page );
+					daisy_t::s_context->VSSetShaderResources( 0, 1, &glyph_srv );
+					daisy_t::s_context->PSSetShaderResources( 0, 1, &srv );
+					daisy_t::s_context->DrawIndexedInstanced( 6, cmd.m_glyph.m_instances, 0, 0, glyph_idx );
+
+					glyph_idx += cmd.m_glyph.m_instances;
+					break;
+				}
 				case daisy_call_kind::CALL_SCISSOR:
 				{
 					D3D11_RECT rect;
@@ -1200,6 +6297,14 @@ float4 main(PS_INPUT input) : SV_TARGET
 			}
 		}
 
+		// Draws what has been recorded so far and starts over, e.g. to hand finished parts of a frame to the GPU
+		// while the rest is still being recorded (cheapest with set_ring_upload)
+		void submit( ) noexcept
+		{
+			this->flush( );
+			this->clear( );
+		}
+
 		void push_scissor( point_t& position, point_t& size ) noexcept
 		{
 			daisy_drawcall_t d {};
@@ -1213,26 +6318,37 @@ float4 main(PS_INPUT input) : SV_TARGET
 		void push_gradient_rectangle( const point_t& position, const point_t& size, const color_t c1, const color_t c2, const color_t c3, const color_t c4,
 			ID3D11ShaderResourceView* texture_srv = nullptr, const point_t& uv_mins = { 0.f, 0.f }, const point_t& uv_maxs = { 1.f, 1.f } ) noexcept
 		{
+			if ( this->m_instanced_rects )
+			{
+				this->push_rect_instance( daisy_rect_t { { position.x, position.y, size.x, size.y }, { c1.bgra, c2.bgra, c3.bgra, c4.bgra },
+					{ uv_mins.x, uv_mins.y, uv_maxs.x, uv_maxs.y } }, texture_srv );
+				return;
+			}
+
 			this->ensure_buffers_capacity( 4, 6 );
 
-			uint32_t additional_indices = this->begin_batch( texture_srv );
+			const auto slot = this->texture_slot( texture_srv );
+			const point_t uv1 = { uv_mins.x * slot.m_uv_scale[ 0 ], uv_mins.y * slot.m_uv_scale[ 1 ] };
+			const point_t uv2 = { uv_maxs.x * slot.m_uv_scale[ 0 ], uv_maxs.y * slot.m_uv_scale[ 1 ] };
+
+			uint32_t additional_indices = this->begin_batch( texture_srv, 4 );
 
 			auto vtx_counter = 0, idx_counter = 0;
 
 			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
-			uint16_t* idx = reinterpret_cast< uint16_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( uint16_t ) * this->m_idxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
 
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { floorf( position.x ), floorf( position.y ), 0.0f, 1.f }, c1.bgra, { uv_mins.x, uv_mins.y } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { floorf( position.x + size.x ), floorf( position.y ), 0.0f, 1.f }, c2.bgra, { uv_maxs.x, uv_mins.y } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { floorf( position.x + size.x ), floorf( position.y + size.y ), 0.0f, 1.f }, c4.bgra, { uv_maxs.x, uv_maxs.y } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { floorf( position.x ), floorf( position.y + size.y ), 0.0f, 1.f }, c3.bgra, { uv_mins.x, uv_maxs.y } };
+			vtx[ vtx_counter++ ] = daisy_make_vtx( floorf( position.x ), floorf( position.y ), c1.bgra, uv1.x, uv1.y, slot.m_slice );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( floorf( position.x + size.x ), floorf( position.y ), c2.bgra, uv2.x, uv1.y, slot.m_slice );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( floorf( position.x + size.x ), floorf( position.y + size.y ), c4.bgra, uv2.x, uv2.y, slot.m_slice );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( floorf( position.x ), floorf( position.y + size.y ), c3.bgra, uv1.x, uv2.y, slot.m_slice );
 
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 3 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 3 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 2 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 1 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 3 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 3 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 2 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 1 );
 
 			this->m_vtxs.m_size += 4;
 			this->m_idxs.m_size += 6;
@@ -1251,20 +6367,23 @@ float4 main(PS_INPUT input) : SV_TARGET
 		{
 			this->ensure_buffers_capacity( 3, 3 );
 
-			uint32_t additional_indices = this->begin_batch( texture_srv );
+			const auto slot = this->texture_slot( texture_srv );
+			const float su = slot.m_uv_scale[ 0 ], sv = slot.m_uv_scale[ 1 ];
+
+			uint32_t additional_indices = this->begin_batch( texture_srv, 3 );
 
 			auto vtx_counter = 0, idx_counter = 0;
 
 			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
-			uint16_t* idx = reinterpret_cast< uint16_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( uint16_t ) * this->m_idxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
 
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p1.x, p1.y, 0.0f, 1.f }, c1.bgra, { uv1.x, uv1.y } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p2.x, p2.y, 0.0f, 1.f }, c2.bgra, { uv2.x, uv2.y } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p3.x, p3.y, 0.0f, 1.f }, c3.bgra, { uv3.x, uv3.y } };
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p1.x, p1.y, c1.bgra, uv1.x * su, uv1.y * sv, slot.m_slice );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p2.x, p2.y, c2.bgra, uv2.x * su, uv2.y * sv, slot.m_slice );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p3.x, p3.y, c3.bgra, uv3.x * su, uv3.y * sv, slot.m_slice );
 
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 2 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 1 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 2 );
 
 			this->m_vtxs.m_size += 3;
 			this->m_idxs.m_size += 3;
@@ -1276,7 +6395,11 @@ float4 main(PS_INPUT input) : SV_TARGET
 		{
 			this->ensure_buffers_capacity( 4, 6 );
 
-			uint32_t additional_indices = this->begin_batch( nullptr );
+			ID3D11ShaderResourceView* texture_srv = nullptr;
+			const auto slot = this->texture_slot( texture_srv );
+			const float su = slot.m_uv_scale[ 0 ], sv = slot.m_uv_scale[ 1 ];
+
+			uint32_t additional_indices = this->begin_batch( texture_srv, 4 );
 
 			point_t delta = { p2.x - p1.x, p2.y - p1.y };
 			float length = sqrtf( delta.x * delta.x + delta.y * delta.y ) + FLT_EPSILON;
@@ -1287,89 +6410,194 @@ float4 main(PS_INPUT input) : SV_TARGET
 			auto vtx_counter = 0, idx_counter = 0;
 
 			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
-			uint16_t* idx = reinterpret_cast< uint16_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( uint16_t ) * this->m_idxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
 
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p1.x - radius.x, p1.y - radius.y, 0.0f, 1.f }, col.bgra, { 0.f, 0.f } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p1.x + radius.x, p1.y + radius.y, 0.0f, 1.f }, col.bgra, { 1.f, 0.f } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p2.x - radius.x, p2.y - radius.y, 0.0f, 1.f }, col.bgra, { 1.f, 1.f } };
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { p2.x + radius.x, p2.y + radius.y, 0.0f, 1.f }, col.bgra, { 0.f, 1.f } };
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p1.x - radius.x, p1.y - radius.y, col.bgra, 0.f, 0.f );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p1.x + radius.x, p1.y + radius.y, col.bgra, su, 0.f );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p2.x - radius.x, p2.y - radius.y, col.bgra, su, sv );
+			vtx[ vtx_counter++ ] = daisy_make_vtx( p2.x + radius.x, p2.y + radius.y, col.bgra, 0.f, sv );
 
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 2 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 2 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 3 );
-			idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 1 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 2 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 2 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 3 );
+			idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + 1 );
 
 			this->m_vtxs.m_size += 4;
 			this->m_idxs.m_size += 6;
 
-			this->end_batch( additional_indices, 4, 6, 2, nullptr );
+			this->end_batch( additional_indices, 4, 6, 2, texture_srv );
 		}
 
-		void push_filled_circle( const point_t& center, const float radius, const int segments, const color_t& center_color, const color_t& outer_color )
+		// segments 0 or less picks the count from radius and circle_tolerance( )
+		void push_filled_circle( const point_t& center, const float radius, const int segments, const color_t& center_color, const color_t& outer_color ) noexcept
 		{
-			this->ensure_buffers_capacity( static_cast< uint32_t >( segments + 1 ), static_cast< uint32_t >( segments * 3 ) );
+			const auto& table = this->circle_table( this->circle_segments( radius, segments ) );
+			this->push_fan( center, radius, table.data( ), static_cast< uint32_t >( table.size( ) ), true, center_color, outer_color );
+		}
 
-			constexpr static auto Pi = 3.14159265358979323846f;
-			constexpr static auto Pi2 = Pi * Pi;
+		void push_filled_circle( const point_t& center, const float radius, const color_t& center_color, const color_t& outer_color ) noexcept
+		{
+			this->push_filled_circle( center, radius, 0, center_color, outer_color );
+		}
 
-			uint32_t additional_indices = this->begin_batch( nullptr );
+		// Circle outline width pixels wide, centered on radius
+		void push_circle( const point_t& center, const float radius, const color_t& col, const float width = 1.f, const int segments = 0 ) noexcept
+		{
+			this->push_ring( center, radius - width * 0.5f, radius + width * 0.5f, col, segments );
+		}
 
-			auto vtx_counter = 0, idx_counter = 0;
+		void push_ring( const point_t& center, const float inner_radius, const float outer_radius, const color_t& col, const int segments = 0 ) noexcept
+		{
+			const auto& table = this->circle_table( this->circle_segments( outer_radius, segments ) );
+			this->push_band( center, max( inner_radius, 0.f ), outer_radius, table.data( ), static_cast< uint32_t >( table.size( ) ), true, col );
+		}
 
-			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
-			uint16_t* idx = reinterpret_cast< uint16_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( uint16_t ) * this->m_idxs.m_size ) );
+		// Arc outline width pixels wide from angle from to angle to, in radians clockwise from +x (y points down)
+		// - segments is for the whole circle, the arc gets its share
+		void push_arc( const point_t& center, const float radius, float from, float to, const color_t& col, const float width = 1.f, const int segments = 0 ) noexcept
+		{
+			if ( to < from )
+				stl::swap( from, to );
+
+			if ( to - from >= 2.f * daisy_pi )
+				return this->push_circle( center, radius, col, width, segments );
+
+			const auto& directions = this->arc_directions( from, to, this->circle_segments( radius + width * 0.5f, segments ) );
+			this->push_band( center, max( radius - width * 0.5f, 0.f ), radius + width * 0.5f, directions.data( ), static_cast< uint32_t >( directions.size( ) ), false, col );
+		}
+
+		// Pie slice from angle from to angle to, see push_arc
+		void push_pie( const point_t& center, const float radius, float from, float to, const color_t& center_color, const color_t& outer_color,
+			const int segments = 0 ) noexcept
+		{
+			if ( to < from )
+				stl::swap( from, to );
+
+			if ( to - from >= 2.f * daisy_pi )
+				return this->push_filled_circle( center, radius, segments, center_color, outer_color );
+
+			const auto& directions = this->arc_directions( from, to, this->circle_segments( radius, segments ) );
+			this->push_fan( center, radius, directions.data( ), static_cast< uint32_t >( directions.size( ) ), false, center_color, outer_color );
+		}
+
+		// Rounded rectangle drawn as one instance, its edges anti-aliased by the shape pixel shader
+		// - border_width pixels inside the edge take border, softness widens the edge ramp to that many pixels
+		void push_shape( const point_t& position, const point_t& size, const float radius, const color_t& fill, const color_t& border = color_t( 0, 0, 0, 0 ),
+			const float border_width = 0.f, const float softness = 0.f ) noexcept
+		{
+			this->push_shape_instance( daisy_rect_t { { position.x, position.y, size.x, size.y }, { fill.bgra, border.bgra, 0u, 0u },
+				{ radius, border_width, softness, 0.f } } );
+		}
+
+		void push_rounded_rectangle( const point_t& position, const point_t& size, const float radius, const color_t& col ) noexcept
+		{
+			this->push_shape( position, size, radius, col );
+		}
+
+		void push_rounded_outline( const point_t& position, const point_t& size, const float radius, const color_t& col, const float width = 1.f ) noexcept
+		{
+			this->push_shape( position, size, radius, color_t( 0, 0, 0, 0 ), col, width );
+		}
+
+		// Anti-aliased disc, with border_width pixels of border inside its edge
+		void push_smooth_circle( const point_t& center, const float radius, const color_t& fill, const color_t& border = color_t( 0, 0, 0, 0 ),
+			const float border_width = 0.f ) noexcept
+		{
+			this->push_shape( { center.x - radius, center.y - radius }, { radius * 2.f, radius * 2.f }, radius, fill, border, border_width );
+		}
+
+		// Anti-aliased circle outline width pixels wide, centered on radius
+		void push_smooth_ring( const point_t& center, const float radius, const color_t& col, const float width = 1.f ) noexcept
+		{
+			const float outer = radius + width * 0.5f;
+			this->push_shape( { center.x - outer, center.y - outer }, { outer * 2.f, outer * 2.f }, outer, color_t( 0, 0, 0, 0 ), col, width );
+		}
 
-			vtx[ vtx_counter++ ] = daisy_vtx_t { { center.x, center.y, 0.0f, 1.f }, center_color.bgra, { 0.f, 0.f } };
+		// Soft shadow under a rounded rectangle, blur pixels of falloff centered on its edge
+		void push_shadow( const point_t& position, const point_t& size, const float radius, const color_t& col, const float blur ) noexcept
+		{
+			this->push_shape( position, size, radius, col, color_t( 0, 0, 0, 0 ), 0.f, blur );
+		}
+
+		// Strokes every subpath of path width pixels wide in one batch of shared vertices
+		// - joins past miter_limit (miter length over half the width) are bevelled
+		void push_path_stroke( const c_path& path, const color_t& col, const float width = 1.f, const daisy_line_join join = LINE_JOIN_MITER,
+			const daisy_line_cap cap = LINE_CAP_BUTT, const float miter_limit = 4.f ) noexcept
+		{
+			this->m_path_points.clear( );
+			this->m_path_indices.clear( );
 
-			for ( int i = 0; i <= segments; ++i )
+			for ( const auto& subpath : path.subpaths( ) )
 			{
-				float theta = ( 2.f * Pi2 * i ) / segments;
-				float x = center.x + radius * cosf( theta );
-				float y = center.y + radius * sinf( theta );
+				this->stroke_polyline( path.points( ).data( ) + subpath.m_first, subpath.m_count, subpath.m_closed, width, join, cap, miter_limit );
 
-				auto last_iteration = ( i == segments );
+				// keep well inside what one drawcall can index
+				if ( this->m_path_points.size( ) > daisy_max_batch_vertices / 2 )
+					this->push_path_mesh( col );
+			}
 
-				if ( !last_iteration )
-					vtx[ vtx_counter++ ] = daisy_vtx_t { { x, y, 0.0f, 1.f }, outer_color.bgra, { 0.f, 0.f } };
+			this->push_path_mesh( col );
+		}
 
-				if ( i )
-				{
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices );
+		// Fills every subpath of path as a simple polygon, closed or not; holes and self-intersections aren't handled
+		void push_path_fill( const c_path& path, const color_t& col ) noexcept
+		{
+			this->m_path_points.clear( );
+			this->m_path_indices.clear( );
 
-					if ( last_iteration )
-					{
-						idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + i );
-						idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + 1 );
-					}
-					else
-					{
-						idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + i );
-						idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + i + 1 );
-					}
-				}
+			for ( const auto& subpath : path.subpaths( ) )
+			{
+				this->fill_polygon( path.points( ).data( ) + subpath.m_first, subpath.m_count );
+
+				if ( this->m_path_points.size( ) > daisy_max_batch_vertices / 2 )
+					this->push_path_mesh( col );
 			}
 
-			this->m_vtxs.m_size += vtx_counter;
-			this->m_idxs.m_size += idx_counter;
+			this->push_path_mesh( col );
+		}
+
+		// Strokes count points as one polyline without building a c_path, see push_path_stroke
+		void push_polyline( const point_t* points, const size_t count, const color_t& col, const float width = 1.f, const bool closed = false,
+			const daisy_line_join join = LINE_JOIN_MITER, const daisy_line_cap cap = LINE_CAP_BUTT, const float miter_limit = 4.f ) noexcept
+		{
+			this->m_path_points.clear( );
+			this->m_path_indices.clear( );
 
-			this->end_batch( additional_indices, vtx_counter, idx_counter, segments, nullptr );
+			this->stroke_polyline( points, static_cast< uint32_t >( count ), closed, width, join, cap, miter_limit );
+			this->push_path_mesh( col );
 		}
 
-		template <typename t = stl::string_view>
-		void push_text( c_fontwrapper& font, const point_t& position, const t text, const color_t& color, uint16_t alignment = TEXT_ALIGN_DEFAULT ) noexcept
+		void push_filled_polygon( const point_t* points, const size_t count, const color_t& col ) noexcept
 		{
-			this->ensure_buffers_capacity( static_cast< uint32_t >( text.size( ) * 4 ), static_cast< uint32_t >( text.size( ) * 6 ) );
+			this->m_path_points.clear( );
+			this->m_path_indices.clear( );
 
-			uint32_t additional_indices = this->begin_batch( font.texture_srv( ) );
-			uint32_t cont_vertices = 0, cont_indices = 0, cont_primitives = 0;
+			this->fill_polygon( points, static_cast< uint32_t >( count ) );
+			this->push_path_mesh( col );
+		}
+
+		// size rescales FONT_SDF fonts to that pixel height, 0 draws at the size the font was created with
+		template <typename t = stl::string_view>
+		void push_text( c_fontwrapper& font, const point_t& position, const t text, const color_t& color, uint16_t alignment = TEXT_ALIGN_DEFAULT, float size = 0.f ) noexcept
+		{
+			if ( this->m_text_cache.capacity( ) && !this->m_recording_run && !( this->m_instanced_glyphs && font.glyph_srv( ) && !font.sdf( ) ) )
+			{
+				this->push_cached_text( font, position, text, color, alignment, size );
+				return;
+			}
 
 			point_t corrected_position { position };
 
+			const bool sdf = font.sdf( );
+			const float scale = sdf && size > 0.f && font.size( ) ? size / font.size( ) : 1.f;
+
 			if ( alignment != TEXT_ALIGN_DEFAULT )
 			{
-				const auto size = font.text_extent( text );
+				auto size = font.text_extent( text );
+				size.x *= scale;
+				size.y *= scale;
 
 				if ( alignment & TEXT_ALIGNX_CENTER )
 					corrected_position.x -= floorf( 0.5f * size.x );
@@ -1382,71 +6610,215 @@ float4 main(PS_INPUT input) : SV_TARGET
 					corrected_position.y -= floorf( size.y );
 			}
 
-			corrected_position.x -= font.spacing( );
+			corrected_position.x -= font.spacing( ) * scale;
 
 			float start_x = corrected_position.x;
 			auto space_coords = font.coords( 'A' );
+			const float line_height = ( space_coords[ 3 ] - space_coords[ 1 ] ) * font.height( ) * scale;
+
+			// the glyph instances have no room for a scale or style
+			if ( this->m_instanced_glyphs && font.glyph_srv( ) && !sdf )
+			{
+				this->push_glyph_instances( font, corrected_position, text, color, line_height );
+				return;
+			}
+
+			this->ensure_buffers_capacity( static_cast< uint32_t >( text.size( ) * 4 ), static_cast< uint32_t >( text.size( ) * 6 ) );
+
+			uint32_t page = 0;
+			ID3D11ShaderResourceView* texture_srv = font.page_srv( page );
+			auto slot = this->texture_slot( texture_srv );
+
+			// SDF fonts are never in the texture array, their slice selects the text style instead
+			float slice = sdf ? static_cast< float >( this->m_text_style ) : slot.m_slice;
+
+			// SDF quads cover the margin above and below the cell too, outlines and glows reach into it
+			const float margin_uv = sdf ? static_cast< float >( font.glyph_margin( ) ) / font.height( ) : 0.f;
+			const float margin = sdf ? font.glyph_margin( ) / font.scale( ) * scale : 0.f;
+
+			uint32_t additional_indices = this->begin_batch( texture_srv, 4 );
+			uint32_t cont_vertices = 0, cont_indices = 0, cont_primitives = 0;
 
 			auto vtx_counter = 0, idx_counter = 0;
 
 			daisy_vtx_t* vtx = reinterpret_cast< daisy_vtx_t* >( reinterpret_cast< uintptr_t >( this->m_vtxs.m_data.get( ) ) + ( sizeof( daisy_vtx_t ) * this->m_vtxs.m_size ) );
-			uint16_t* idx = reinterpret_cast< uint16_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( uint16_t ) * this->m_idxs.m_size ) );
+			daisy_idx_t* idx = reinterpret_cast< daisy_idx_t* >( reinterpret_cast< uintptr_t >( this->m_idxs.m_data.get( ) ) + ( sizeof( daisy_idx_t ) * this->m_idxs.m_size ) );
 
-			for ( const auto& c : text )
+			auto points = daisy_code_points( text );
+
+			for ( uint32_t c; points.next( c ); )
 			{
-				if ( c == '\n' || c == L'\n' )
+				if ( c == '\n' )
 				{
 					corrected_position.x = start_x;
-					corrected_position.y += ( space_coords[ 3 ] - space_coords[ 1 ] ) * font.height( );
+					corrected_position.y += line_height;
 					continue;
 				}
 
-				auto is_space = ( c == ' ' || c == L' ' );
-				auto coords = font.coords( c );
+				auto is_space = ( c == ' ' );
+				const uint32_t id = font.glyph_id( c );
+				const auto& glyph = font.glyph( id );
+
+				// glyphs of a lazy font can live on another texture page
+				if ( !is_space && font.glyph_page( id ) != page )
+				{
+					if ( cont_vertices )
+						this->end_batch( additional_indices, cont_vertices, cont_indices, cont_primitives, texture_srv );
+
+					page = font.glyph_page( id );
+					texture_srv = font.page_srv( page );
+					slot = this->texture_slot( texture_srv );
+					slice = sdf ? slice : slot.m_slice;
+
+					additional_indices = this->begin_batch( texture_srv, 4 );
+					cont_vertices = cont_indices = cont_primitives = 0;
+				}
+
+				float tx1 = glyph.m_uv[ 0 ];
+				float ty1 = glyph.m_uv[ 1 ];
+				float tx2 = glyph.m_uv[ 2 ];
+				float ty2 = glyph.m_uv[ 3 ];
 
-				float tx1 = coords[ 0 ];
-				float ty1 = coords[ 1 ];
-				float tx2 = coords[ 2 ];
-				float ty2 = coords[ 3 ];
+				const float w = glyph.m_size[ 0 ] * scale;
+				const float h = glyph.m_size[ 1 ] * scale + 2.f * margin;
+				const float y = corrected_position.y - margin;
 
-				float w = ( tx2 - tx1 ) * font.width( ) / font.scale( );
-				float h = ( ty2 - ty1 ) * font.height( ) / font.scale( );
+				ty1 -= margin_uv;
+				ty2 += margin_uv;
+
+				tx1 *= slot.m_uv_scale[ 0 ];
+				tx2 *= slot.m_uv_scale[ 0 ];
+				ty1 *= slot.m_uv_scale[ 1 ];
+				ty2 *= slot.m_uv_scale[ 1 ];
 
 				if ( !is_space )
 				{
+					// start a new drawcall before the indices of this batch would wrap
+					if ( static_cast< uint64_t >( additional_indices ) + cont_vertices + 4 > daisy_max_batch_vertices )
+					{
+						this->end_batch( additional_indices, cont_vertices, cont_indices, cont_primitives, texture_srv );
+
+						additional_indices = this->begin_batch( texture_srv, 4 );
+						cont_vertices = cont_indices = cont_primitives = 0;
+					}
+
 					daisy_vtx_t v[ ] = {
-						{ { corrected_position.x, corrected_position.y + h, 0.f, 1.f }, color.bgra, { tx1, ty2 } },
-						{ { corrected_position.x, corrected_position.y, 0.f, 1.f }, color.bgra, { tx1, ty1 } },
-						{ { corrected_position.x + w, corrected_position.y + h, 0.f, 1.f }, color.bgra, { tx2, ty2 } },
-						{ { corrected_position.x + w, corrected_position.y, 0.f, 1.f }, color.bgra, { tx2, ty1 } } };
+						daisy_make_vtx( corrected_position.x, y + h, color.bgra, tx1, ty2, slice ),
+						daisy_make_vtx( corrected_position.x, y, color.bgra, tx1, ty1, slice ),
+						daisy_make_vtx( corrected_position.x + w, y + h, color.bgra, tx2, ty2, slice ),
+						daisy_make_vtx( corrected_position.x + w, y, color.bgra, tx2, ty1, slice ) };
 
 					vtx[ vtx_counter++ ] = v[ 0 ];
 					vtx[ vtx_counter++ ] = v[ 1 ];
 					vtx[ vtx_counter++ ] = v[ 2 ];
 					vtx[ vtx_counter++ ] = v[ 3 ];
 
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices );
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices + 1 );
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices + 2 );
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices + 3 );
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices + 2 );
-					idx[ idx_counter++ ] = static_cast< uint16_t >( additional_indices + cont_vertices + 1 );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices + 1 );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices + 2 );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices + 3 );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices + 2 );
+					idx[ idx_counter++ ] = static_cast< daisy_idx_t >( additional_indices + cont_vertices + 1 );
+
+					this->m_vtxs.m_size += 4;
+					this->m_idxs.m_size += 6;
+
+					cont_vertices += 4;
+					cont_indices += 6;
+					cont_primitives += 2;
+				}
+
+				corrected_position.x += glyph.m_advance * scale;
+			}
+
+			this->end_batch( additional_indices, cont_vertices, cont_indices, cont_primitives, texture_srv );
+		}
+	};
+
+	// Lets several threads record at once: each thread pushes into its own CPU-only sub-queue and flush( )
+	// appends them in index order into one queue, so the result is the same as recording them one after another
+	// - recording modes (instanced rects/glyphs, texture array) are set per sub-queue, upload modes
+	//   (backend, ring, retained) on queue( )
+	class c_parallel_queue : public c_daisy_resettable_object
+	{
+	private:
+		c_renderqueue m_queue;
+		stl::vector<stl::unique_ptr<c_renderqueue>> m_sub_queues;
+
+	public:
+		[[nodiscard]] bool create( const uint32_t threads, const uint32_t max_verts = 32767, const uint32_t max_indices = 65535,
+			const uint32_t max_rects = 4096, const uint32_t max_glyphs = 8192 ) noexcept
+		{
+			if ( !threads || !this->m_queue.create( max_verts, max_indices, max_rects, max_glyphs ) )
+				return false;
+
+			this->m_sub_queues.clear( );
+
+			for ( uint32_t i = 0; i < threads; i++ )
+			{
+				auto sub_queue = stl::make_unique<c_renderqueue>( );
+				if ( !sub_queue || !sub_queue->create_local_buffers( max_verts, max_indices, max_rects, max_glyphs ) )
+					return false;
+
+				this->m_sub_queues.push_back( stl::move( sub_queue ) );
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			return this->m_queue.reset( pre_reset );
+		}
+
+		size_t size( ) const noexcept
+		{
+			return this->m_sub_queues.size( );
+		}
+
+		// Only ever touched by the thread that owns index
+		c_renderqueue* sub_queue( size_t index ) noexcept
+		{
+			return index < this->m_sub_queues.size( ) ? this->m_sub_queues[ index ].get( ) : nullptr;
+		}
+
+		// The queue the sub-queues are merged into and that owns the GPU buffers
+		c_renderqueue* queue( ) noexcept
+		{
+			return &this->m_queue;
+		}
+
+		// Not thread-safe: call once every thread is done recording
+		void clear( ) noexcept
+		{
+			for ( auto& sub_queue : this->m_sub_queues )
+				sub_queue->clear( );
+		}
+
+		// Not thread-safe: merges the sub-queues when any of them changed since the last merge and draws the result
+		void flush( ) noexcept
+		{
+			bool changed = false;
+			for ( const auto& sub_queue : this->m_sub_queues )
+				changed |= sub_queue->m_update;
 
-					this->m_vtxs.m_size += 4;
-					this->m_idxs.m_size += 6;
+			if ( changed )
+			{
+				this->m_queue.clear( );
 
-					cont_vertices += 4;
-					cont_indices += 6;
-					cont_primitives += 2;
+				for ( auto& sub_queue : this->m_sub_queues )
+				{
+					this->m_queue.append( *sub_queue );
+					sub_queue->m_update = false;
 				}
-
-				corrected_position.x += w - ( 2.f * font.spacing( ) ) + 1;
 			}
 
-			this->end_batch( additional_indices, cont_vertices, cont_indices, cont_primitives, font.texture_srv( ) );
+			this->m_queue.flush( );
 		}
 	};
 
+	// Two queues flipped by swap( ); nothing keeps the producer out of the queue being flushed,
+	// see c_triplebuffer_queue for a lock-free handoff
 	class c_doublebuffer_queue : public c_daisy_resettable_object
 	{
 	private:
@@ -1486,6 +6858,89 @@ float4 main(PS_INPUT input) : SV_TARGET
 		}
 	};
 
+	// Triple-buffered queue for one producer (game thread) and one consumer (render thread)
+	// - the producer records into queue( ) and publishes it with swap( ), it never waits on the consumer
+	// - flush( ) draws the latest published frame, or the previous one again when nothing new arrived
+	// - the ready slot and its "fresh" flag share one atomic, exchanged with acquire/release on both sides
+	class c_triplebuffer_queue : public c_daisy_resettable_object
+	{
+	private:
+		static constexpr uint32_t fresh_bit = 4, index_mask = 3;
+
+		c_renderqueue m_queues[ 3 ];
+		stl::atomic<uint32_t> m_ready;
+		uint32_t m_write, m_read; // owned by producer/consumer
+		stl::atomic<uint64_t> m_dropped, m_repeated;
+
+	public:
+		c_triplebuffer_queue( ) noexcept
+			: m_ready( 1 ), m_write( 0 ), m_read( 2 ), m_dropped( 0 ), m_repeated( 0 )
+		{
+		}
+
+		[[nodiscard]] bool create( const uint32_t max_verts = 32767, const uint32_t max_indices = 65535 ) noexcept
+		{
+			for ( auto& queue : this->m_queues )
+			{
+				if ( !queue.create( max_verts, max_indices ) )
+					return false;
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] virtual bool reset( bool pre_reset = false ) noexcept override
+		{
+			bool ok = true;
+			for ( auto& queue : this->m_queues )
+				ok &= queue.reset( pre_reset );
+
+			return ok;
+		}
+
+		// Producer: the queue to record the next frame into
+		c_renderqueue* queue( ) noexcept
+		{
+			return &this->m_queues[ this->m_write ];
+		}
+
+		// Producer: publishes the recorded frame and starts an empty one
+		void swap( ) noexcept
+		{
+			const uint32_t previous = this->m_ready.exchange( this->m_write | fresh_bit, stl::memory_order_acq_rel );
+
+			// the consumer never picked up the frame we are replacing
+			if ( previous & fresh_bit )
+				this->m_dropped.fetch_add( 1, stl::memory_order_relaxed );
+
+			this->m_write = previous & index_mask;
+			this->m_queues[ this->m_write ].clear( );
+		}
+
+		// Consumer: draws the latest published frame
+		void flush( ) noexcept
+		{
+			if ( this->m_ready.load( stl::memory_order_relaxed ) & fresh_bit )
+				this->m_read = this->m_ready.exchange( this->m_read, stl::memory_order_acq_rel ) & index_mask;
+			else
+				this->m_repeated.fetch_add( 1, stl::memory_order_relaxed );
+
+			this->m_queues[ this->m_read ].flush( );
+		}
+
+		// Frames published but replaced before the consumer drew them
+		uint64_t dropped( ) const noexcept
+		{
+			return this->m_dropped.load( stl::memory_order_relaxed );
+		}
+
+		// flush( ) calls that found no new frame and drew the previous one again
+		uint64_t repeated( ) const noexcept
+		{
+			return this->m_repeated.load( stl::memory_order_relaxed );
+		}
+	};
+
 	// Initialization and utility functions
 	inline static bool daisy_initialize( ID3D11Device* device, ID3D11DeviceContext* context, float viewport_width, float viewport_height ) noexcept
 	{
@@ -1562,12 +7017,18 @@ float4 main(PS_INPUT input) : SV_TARGET
 		// Create input layout
 		D3D11_INPUT_ELEMENT_DESC layout[ ] =
 		{
+#ifdef DAISY_COMPACT_VERTEX
+			{ "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "COLOR", 0, DXGI_FORMAT_B8G8R8A8_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+#else
 			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 			{ "COLOR", 0, DXGI_FORMAT_B8G8R8A8_UNORM, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+#endif
 		};
 
-		hr = device->CreateInputLayout( layout, 3, vs_blob->GetBufferPointer( ), vs_blob->GetBufferSize( ), &daisy_t::s_input_layout );
+		hr = device->CreateInputLayout( layout, static_cast< UINT >( sizeof( layout ) / sizeof( layout[ 0 ] ) ), vs_blob->GetBufferPointer( ), vs_blob->GetBufferSize( ), &daisy_t::s_input_layout );
 
 		vs_blob->Release( );
 		ps_blob->Release( );
@@ -1575,6 +7036,149 @@ float4 main(PS_INPUT input) : SV_TARGET
 		if ( FAILED( hr ) )
 			return false;
 
+		// Instanced rectangle pipeline
+		{
+			ID3DBlob* rect_vs_blob = nullptr;
+
+			if ( !compile_shader( shaders::rect_vertex_shader_src, "main", "vs_5_0", &rect_vs_blob ) )
+				return false;
+
+			hr = device->CreateVertexShader( rect_vs_blob->GetBufferPointer( ), rect_vs_blob->GetBufferSize( ), nullptr, &daisy_t::s_rect_vertex_shader );
+			if ( FAILED( hr ) )
+			{
+				rect_vs_blob->Release( );
+				return false;
+			}
+
+			D3D11_INPUT_ELEMENT_DESC rect_layout[ ] =
+			{
+				{ "CORNER", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+				{ "RECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 0, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 1, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 20, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 2, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 24, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 3, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 28, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			};
+
+			hr = device->CreateInputLayout( rect_layout, static_cast< UINT >( sizeof( rect_layout ) / sizeof( rect_layout[ 0 ] ) ),
+				rect_vs_blob->GetBufferPointer( ), rect_vs_blob->GetBufferSize( ), &daisy_t::s_rect_input_layout );
+
+			rect_vs_blob->Release( );
+
+			if ( FAILED( hr ) )
+				return false;
+
+			// Unit quad in the same vertex/index order push_gradient_rectangle uses
+			const float quad_vtx[ ] = { 0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f };
+			const uint16_t quad_idx[ ] = { 0, 1, 3, 3, 2, 1 };
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = sizeof( quad_vtx );
+			desc.Usage = D3D11_USAGE_IMMUTABLE;
+			desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+			D3D11_SUBRESOURCE_DATA init_data = {};
+			init_data.pSysMem = quad_vtx;
+
+			if ( FAILED( device->CreateBuffer( &desc, &init_data, &daisy_t::s_unit_quad_vtx ) ) )
+				return false;
+
+			desc.ByteWidth = sizeof( quad_idx );
+			desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+			init_data.pSysMem = quad_idx;
+
+			if ( FAILED( device->CreateBuffer( &desc, &init_data, &daisy_t::s_unit_quad_idx ) ) )
+				return false;
+		}
+
+		// Shape pipeline, reads the rect instance layout
+		{
+			ID3DBlob* shape_vs_blob = nullptr;
+			ID3DBlob* shape_ps_blob = nullptr;
+
+			if ( !compile_shader( shaders::shape_vertex_shader_src, "main", "vs_5_0", &shape_vs_blob ) )
+				return false;
+
+			if ( !compile_shader( shaders::shape_pixel_shader_src, "main", "ps_5_0", &shape_ps_blob ) )
+			{
+				shape_vs_blob->Release( );
+				return false;
+			}
+
+			hr = device->CreateVertexShader( shape_vs_blob->GetBufferPointer( ), shape_vs_blob->GetBufferSize( ), nullptr, &daisy_t::s_shape_vertex_shader );
+			if ( SUCCEEDED( hr ) )
+				hr = device->CreatePixelShader( shape_ps_blob->GetBufferPointer( ), shape_ps_blob->GetBufferSize( ), nullptr, &daisy_t::s_shape_pixel_shader );
+
+			shape_vs_blob->Release( );
+			shape_ps_blob->Release( );
+
+			if ( FAILED( hr ) )
+				return false;
+		}
+
+		// Instanced glyph pipeline
+		{
+			ID3DBlob* glyph_vs_blob = nullptr;
+
+			if ( !compile_shader( shaders::glyph_vertex_shader_src, "main", "vs_5_0", &glyph_vs_blob ) )
+				return false;
+
+			hr = device->CreateVertexShader( glyph_vs_blob->GetBufferPointer( ), glyph_vs_blob->GetBufferSize( ), nullptr, &daisy_t::s_glyph_vertex_shader );
+			if ( FAILED( hr ) )
+			{
+				glyph_vs_blob->Release( );
+				return false;
+			}
+
+			D3D11_INPUT_ELEMENT_DESC glyph_layout[ ] =
+			{
+				{ "CORNER", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+				{ "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "GLYPH", 0, DXGI_FORMAT_R32_UINT, 1, 8, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 0, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 12, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			};
+
+			hr = device->CreateInputLayout( glyph_layout, static_cast< UINT >( sizeof( glyph_layout ) / sizeof( glyph_layout[ 0 ] ) ),
+				glyph_vs_blob->GetBufferPointer( ), glyph_vs_blob->GetBufferSize( ), &daisy_t::s_glyph_input_layout );
+
+			glyph_vs_blob->Release( );
+
+			if ( FAILED( hr ) )
+				return false;
+		}
+
+		// FONT_SDF text: distance test pixel shader and the text style constants it reads
+		{
+			ID3DBlob* sdf_ps_blob = nullptr;
+
+			if ( !compile_shader( shaders::sdf_pixel_shader_src, "main", "ps_5_0", &sdf_ps_blob ) )
+				return false;
+
+			hr = device->CreatePixelShader( sdf_ps_blob->GetBufferPointer( ), sdf_ps_blob->GetBufferSize( ), nullptr, &daisy_t::s_sdf_pixel_shader );
+			sdf_ps_blob->Release( );
+
+			if ( FAILED( hr ) )
+				return false;
+
+			// OutlineColor, GlowColor and Widths, one float4 of each per style
+			const float styles[ 3 * daisy_max_text_styles * 4 ] = { };
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = sizeof( styles );
+			desc.Usage = D3D11_USAGE_DEFAULT;
+			desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+			D3D11_SUBRESOURCE_DATA init_data = {};
+			init_data.pSysMem = styles;
+
+			if ( FAILED( device->CreateBuffer( &desc, &init_data, &daisy_t::s_text_style_buffer ) ) )
+				return false;
+
+			// style 0 is plain text
+			daisy_t::s_text_styles.assign( 1, daisy_text_style_t { } );
+		}
+
 		// Create blend state
 		D3D11_BLEND_DESC blend_desc = {};
 		blend_desc.AlphaToCoverageEnable = FALSE;
@@ -1628,6 +7232,13 @@ float4 main(PS_INPUT input) : SV_TARGET
 		if ( FAILED( hr ) )
 			return false;
 
+		// distance fields are interpolated, point sampling them would give blocky edges when scaled up
+		sampler_desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+
+		hr = device->CreateSamplerState( &sampler_desc, &daisy_t::s_linear_sampler_state );
+		if ( FAILED( hr ) )
+			return false;
+
 		return true;
 	}
 
@@ -1657,8 +7268,161 @@ float4 main(PS_INPUT input) : SV_TARGET
 		daisy_t::s_context->RSSetScissorRects( 1, &default_rect );
 	}
 
+	inline static void daisy_release_texture_array( ) noexcept
+	{
+		if ( daisy_t::s_array_pixel_shader )
+		{
+			daisy_t::s_array_pixel_shader->Release( );
+			daisy_t::s_array_pixel_shader = nullptr;
+		}
+
+		if ( daisy_t::s_texture_array_srv )
+		{
+			daisy_t::s_texture_array_srv->Release( );
+			daisy_t::s_texture_array_srv = nullptr;
+		}
+
+		if ( daisy_t::s_texture_array )
+		{
+			daisy_t::s_texture_array->Release( );
+			daisy_t::s_texture_array = nullptr;
+		}
+
+		daisy_t::s_texture_slices.clear( );
+		daisy_t::s_texture_array_free.clear( );
+		daisy_t::s_texture_array_size = daisy_t::s_texture_array_slices = daisy_t::s_texture_array_used = 0;
+	}
+
+	// Creates the Texture2DArray used by c_renderqueue::set_texture_array
+	// - every slice is slice_size x slice_size BGRA, slice 0 is reserved for the white texture
+	// - needs the full vertex layout, DAISY_COMPACT_VERTEX has nowhere to put the slice
+	inline static bool daisy_create_texture_array( uint32_t slice_size = 2048, uint32_t max_slices = 16 ) noexcept
+	{
+#ifdef DAISY_COMPACT_VERTEX
+		( void ) slice_size;
+		( void ) max_slices;
+		return false;
+#else
+		if ( !daisy_t::s_device || !daisy_t::s_context || !slice_size || max_slices < 2 )
+			return false;
+
+		daisy_release_texture_array( );
+
+		D3D11_TEXTURE2D_DESC tex_desc = {};
+		tex_desc.Width = slice_size;
+		tex_desc.Height = slice_size;
+		tex_desc.MipLevels = 1;
+		tex_desc.ArraySize = max_slices;
+		tex_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+		tex_desc.SampleDesc.Count = 1;
+		tex_desc.Usage = D3D11_USAGE_DEFAULT;
+		tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+		if ( FAILED( daisy_t::s_device->CreateTexture2D( &tex_desc, nullptr, &daisy_t::s_texture_array ) ) )
+			return false;
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+		srv_desc.Format = tex_desc.Format;
+		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srv_desc.Texture2DArray.MipLevels = 1;
+		srv_desc.Texture2DArray.ArraySize = max_slices;
+
+		if ( FAILED( daisy_t::s_device->CreateShaderResourceView( daisy_t::s_texture_array, &srv_desc, &daisy_t::s_texture_array_srv ) ) )
+		{
+			daisy_release_texture_array( );
+			return false;
+		}
+
+		ID3DBlob* ps_blob = nullptr;
+		if ( !compile_shader( shaders::array_pixel_shader_src, "main", "ps_5_0", &ps_blob ) )
+		{
+			daisy_release_texture_array( );
+			return false;
+		}
+
+		HRESULT hr = daisy_t::s_device->CreatePixelShader( ps_blob->GetBufferPointer( ), ps_blob->GetBufferSize( ), nullptr, &daisy_t::s_array_pixel_shader );
+		ps_blob->Release( );
+
+		if ( FAILED( hr ) )
+		{
+			daisy_release_texture_array( );
+			return false;
+		}
+
+		// white texel for untextured geometry
+		const uint32_t white_pixel = 0xFFFFFFFF;
+		const D3D11_BOX white_box = { 0, 0, 0, 1, 1, 1 };
+		daisy_t::s_context->UpdateSubresource( daisy_t::s_texture_array, 0, &white_box, &white_pixel, 4, 0 );
+
+		daisy_t::s_texture_array_size = slice_size;
+		daisy_t::s_texture_array_slices = max_slices;
+		daisy_t::s_texture_array_used = 1;
+
+		return true;
+#endif
+	}
+
+	// Copies a BGRA texture into its own texture array slice; call again after its contents change
+	// (e.g. c_texatlas::append) to refresh the slice
+	// - the owner unregisters its views when it releases them (reset( true ), erase, destruction), so register
+	//   again after it recreated them; views daisy doesn't own need daisy_unregister_texture before release
+	inline static bool daisy_register_texture( ID3D11ShaderResourceView* texture_srv, ID3D11Texture2D* texture, uint32_t width, uint32_t height ) noexcept
+	{
+		if ( !daisy_t::s_texture_array || !texture_srv || !texture )
+			return false;
+
+		if ( width > daisy_t::s_texture_array_size || height > daisy_t::s_texture_array_size )
+			return false;
+
+		auto it = daisy_t::s_texture_slices.find( texture_srv );
+
+		if ( it == daisy_t::s_texture_slices.end( ) )
+		{
+			auto& free_slices = daisy_t::s_texture_array_free;
+			if ( free_slices.empty( ) && daisy_t::s_texture_array_used >= daisy_t::s_texture_array_slices )
+				return false;
+
+			uint32_t slice;
+			if ( !free_slices.empty( ) )
+			{
+				slice = free_slices.back( );
+				free_slices.pop_back( );
+			}
+			else
+				slice = daisy_t::s_texture_array_used++;
+
+			const float size = static_cast< float >( daisy_t::s_texture_array_size );
+			const daisy_slice_t slot { static_cast< float >( slice ), { width / size, height / size } };
+
+			it = daisy_t::s_texture_slices.emplace( texture_srv, slot ).first;
+		}
+
+		const D3D11_BOX box = { 0, 0, 0, width, height, 1 };
+		daisy_t::s_context->CopySubresourceRegion( daisy_t::s_texture_array, static_cast< UINT >( it->second.m_slice ), 0, 0, 0, texture, 0, &box );
+
+		return true;
+	}
+
+	// Lazy fonts keep rasterizing into their own pages, a copy in the array would go stale, A8 fonts can't be
+	// copied into the BGRA array and SDF fonts need their own pixel shader
+	inline static bool daisy_register_texture( const c_fontwrapper& font ) noexcept
+	{
+		if ( font.lazy( ) || font.sdf( ) || font.texture_format( ) != DXGI_FORMAT_B8G8R8A8_UNORM )
+			return false;
+
+		return daisy_register_texture( font.texture_srv( ), font.texture( ), font.width( ), font.height( ) );
+	}
+
+	inline static bool daisy_register_texture( const c_texatlas& atlas ) noexcept
+	{
+		return daisy_register_texture( atlas.texture_srv( ), atlas.texture( ),
+			static_cast< uint32_t >( atlas.dimensions( ).x ), static_cast< uint32_t >( atlas.dimensions( ).y ) );
+	}
+
 	inline static void daisy_shutdown( ) noexcept
 	{
+		daisy_release_texture_array( );
+
 		if ( daisy_t::s_vertex_shader )
 		{
 			daisy_t::s_vertex_shader->Release( );
@@ -1677,6 +7441,54 @@ float4 main(PS_INPUT input) : SV_TARGET
 			daisy_t::s_input_layout = nullptr;
 		}
 
+		if ( daisy_t::s_rect_vertex_shader )
+		{
+			daisy_t::s_rect_vertex_shader->Release( );
+			daisy_t::s_rect_vertex_shader = nullptr;
+		}
+
+		if ( daisy_t::s_rect_input_layout )
+		{
+			daisy_t::s_rect_input_layout->Release( );
+			daisy_t::s_rect_input_layout = nullptr;
+		}
+
+		if ( daisy_t::s_shape_vertex_shader )
+		{
+			daisy_t::s_shape_vertex_shader->Release( );
+			daisy_t::s_shape_vertex_shader = nullptr;
+		}
+
+		if ( daisy_t::s_shape_pixel_shader )
+		{
+			daisy_t::s_shape_pixel_shader->Release( );
+			daisy_t::s_shape_pixel_shader = nullptr;
+		}
+
+		if ( daisy_t::s_unit_quad_vtx )
+		{
+			daisy_t::s_unit_quad_vtx->Release( );
+			daisy_t::s_unit_quad_vtx = nullptr;
+		}
+
+		if ( daisy_t::s_unit_quad_idx )
+		{
+			daisy_t::s_unit_quad_idx->Release( );
+			daisy_t::s_unit_quad_idx = nullptr;
+		}
+
+		if ( daisy_t::s_glyph_vertex_shader )
+		{
+			daisy_t::s_glyph_vertex_shader->Release( );
+			daisy_t::s_glyph_vertex_shader = nullptr;
+		}
+
+		if ( daisy_t::s_glyph_input_layout )
+		{
+			daisy_t::s_glyph_input_layout->Release( );
+			daisy_t::s_glyph_input_layout = nullptr;
+		}
+
 		if ( daisy_t::s_blend_state )
 		{
 			daisy_t::s_blend_state->Release( );
@@ -1701,6 +7513,26 @@ float4 main(PS_INPUT input) : SV_TARGET
 			daisy_t::s_sampler_state = nullptr;
 		}
 
+		if ( daisy_t::s_linear_sampler_state )
+		{
+			daisy_t::s_linear_sampler_state->Release( );
+			daisy_t::s_linear_sampler_state = nullptr;
+		}
+
+		if ( daisy_t::s_sdf_pixel_shader )
+		{
+			daisy_t::s_sdf_pixel_shader->Release( );
+			daisy_t::s_sdf_pixel_shader = nullptr;
+		}
+
+		if ( daisy_t::s_text_style_buffer )
+		{
+			daisy_t::s_text_style_buffer->Release( );
+			daisy_t::s_text_style_buffer = nullptr;
+		}
+
+		daisy_t::s_text_styles.clear( );
+
 		if ( daisy_t::s_white_texture_srv )
 		{
 			daisy_t::s_white_texture_srv->Release( );
@@ -1732,6 +7564,50 @@ float4 main(PS_INPUT input) : SV_TARGET
 		daisy_t::s_viewport_height = height;
 	}
 
+	// Baked fonts created after this load their atlas from directory when a matching one was saved there and save it
+	// otherwise, so later runs and resets skip rasterizing. an empty directory turns the cache off
+	inline static void daisy_set_font_cache( const stl::string_view directory ) noexcept
+	{
+		daisy_t::s_font_cache_directory = directory;
+
+		if ( !directory.empty( ) )
+			CreateDirectoryA( daisy_t::s_font_cache_directory.c_str( ), nullptr );
+	}
+
+	// Adds an outline/glow style for FONT_SDF text and returns the index to pass to c_renderqueue::set_text_style,
+	// or 0 (plain text) once daisy_max_text_styles are in use
+	// - updates the style constants on the immediate context, call it from the render thread
+	inline static uint32_t daisy_add_text_style( const daisy_text_style_t& style ) noexcept
+	{
+		if ( !daisy_t::s_text_style_buffer || daisy_t::s_text_styles.size( ) >= daisy_max_text_styles )
+			return 0;
+
+		daisy_t::s_text_styles.push_back( style );
+
+		float styles[ 3 ][ daisy_max_text_styles ][ 4 ] = { };
+
+		for ( size_t i = 0; i < daisy_t::s_text_styles.size( ); i++ )
+		{
+			const auto& entry = daisy_t::s_text_styles[ i ];
+			const color_t colors[ 2 ] = { entry.m_outline_color, entry.m_glow_color };
+
+			for ( uint32_t c = 0; c < 2; c++ )
+			{
+				styles[ c ][ i ][ 0 ] = colors[ c ].chan.r / 255.f;
+				styles[ c ][ i ][ 1 ] = colors[ c ].chan.g / 255.f;
+				styles[ c ][ i ][ 2 ] = colors[ c ].chan.b / 255.f;
+				styles[ c ][ i ][ 3 ] = colors[ c ].chan.a / 255.f;
+			}
+
+			styles[ 2 ][ i ][ 0 ] = entry.m_outline_width;
+			styles[ 2 ][ i ][ 1 ] = entry.m_glow_width;
+		}
+
+		daisy_t::s_context->UpdateSubresource( daisy_t::s_text_style_buffer, 0, nullptr, styles, 0, 0 );
+
+		return static_cast< uint32_t >( daisy_t::s_text_styles.size( ) - 1 );
+	}
+
 } // namespace daisy
 
 #endif // _SSE2_DAISY_DX11_INCLUDE_GUARD
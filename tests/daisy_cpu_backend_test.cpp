@@ -0,0 +1,135 @@
+// daisy_cpu_backend_test - records small scenes into a c_renderqueue, rasterizes them with c_cpu_backend and checks pixels
+// - build (Windows): cl /O2 /std:c++17 /EHsc tests\daisy_cpu_backend_test.cpp
+// - build (no Windows SDK): g++ -std=c++17 -DDAISY_NO_D3D11 tests/daisy_cpu_backend_test.cpp -o daisy_cpu_backend_test
+// - exits with the number of failed checks, every failure is printed
+
+#include <cstdio>
+#include <vector>
+
+#include "../daisy_dx11.h"
+
+namespace
+{
+	constexpr uint32_t width = 64, height = 64;
+
+	uint32_t g_failures = 0;
+
+	void check( bool passed, const char* what, uint32_t x, uint32_t y, uint32_t pixel ) noexcept
+	{
+		if ( passed )
+			return;
+
+		printf( "FAIL %s: pixel ( %u, %u ) is %08X\n", what, x, y, pixel );
+		g_failures++;
+	}
+
+	// BGRA as stored by c_cpu_backend, 0xAARRGGBB
+	constexpr uint32_t bgra( uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255 ) noexcept
+	{
+		return ( static_cast< uint32_t >( a ) << 24 ) | ( static_cast< uint32_t >( r ) << 16 ) | ( static_cast< uint32_t >( g ) << 8 ) | b;
+	}
+
+	uint32_t pixel( const daisy::c_cpu_backend& cpu, uint32_t x, uint32_t y ) noexcept
+	{
+		return cpu.pixels( )[ y * cpu.width( ) + x ];
+	}
+
+	// Every pixel of the image is expected inside [x1, x2) x [y1, y2) and background outside
+	void check_rect( const daisy::c_cpu_backend& cpu, const char* what, uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2, uint32_t inside, uint32_t outside ) noexcept
+	{
+		for ( uint32_t y = 0; y < height; y++ )
+		{
+			for ( uint32_t x = 0; x < width; x++ )
+			{
+				const bool in = x >= x1 && x < x2 && y >= y1 && y < y2;
+				const uint32_t got = pixel( cpu, x, y );
+
+				if ( got != ( in ? inside : outside ) )
+				{
+					check( false, what, x, y, got );
+					return;
+				}
+			}
+		}
+	}
+
+	// Rasterizes what record pushes, through the vertex stream or as rect instances
+	template <typename f>
+	void render( daisy::c_cpu_backend& cpu, bool instanced, f record ) noexcept
+	{
+		daisy::c_renderqueue queue;
+		queue.set_backend( &cpu );
+		queue.set_instanced_rects( instanced );
+
+		if ( !queue.create( ) )
+		{
+			printf( "FAIL queue.create( )\n" );
+			g_failures++;
+			return;
+		}
+
+		cpu.clear( daisy::color_t( 0, 0, 0, 255 ) );
+		record( queue );
+		queue.flush( );
+	}
+}
+
+int main( )
+{
+	daisy::daisy_set_viewport( static_cast< float >( width ), static_cast< float >( height ) );
+
+	daisy::c_cpu_backend cpu;
+	if ( !cpu.create( width, height ) )
+	{
+		printf( "FAIL cpu.create( )\n" );
+		return 1;
+	}
+
+	for ( const bool instanced : { false, true } )
+	{
+		const char* path = instanced ? "instanced" : "vertices";
+
+		// pixel-aligned rectangle: exactly the pixels whose centers it covers, nothing bleeds past its edges
+		render( cpu, instanced, [ ]( daisy::c_renderqueue& queue )
+			{
+				queue.push_filled_rectangle( { 8.f, 4.f }, { 16.f, 12.f }, daisy::color_t( 255, 0, 0 ) );
+			} );
+		printf( "%s: opaque rect\n", path );
+		check_rect( cpu, "opaque rect", 8, 4, 24, 16, bgra( 255, 0, 0 ), bgra( 0, 0, 0 ) );
+
+		// half transparent white over black blends SRC_ALPHA/INV_SRC_ALPHA
+		render( cpu, instanced, [ ]( daisy::c_renderqueue& queue )
+			{
+				queue.push_filled_rectangle( { 0.f, 0.f }, { 32.f, 32.f }, daisy::color_t( 255, 255, 255, 128 ) );
+			} );
+		printf( "%s: blended rect\n", path );
+		const uint32_t blended = pixel( cpu, 10, 10 );
+		const uint32_t channel = blended & 0xFF;
+		check( channel >= 127 && channel <= 129 && ( blended >> 8 & 0xFF ) == channel && ( blended >> 16 & 0xFF ) == channel, "blended rect", 10, 10, blended );
+		check( pixel( cpu, 40, 40 ) == bgra( 0, 0, 0 ), "blended rect background", 40, 40, pixel( cpu, 40, 40 ) );
+
+		// a scissor cuts the rectangle down to the overlap
+		render( cpu, instanced, [ ]( daisy::c_renderqueue& queue )
+			{
+				daisy::point_t position { 16.f, 16.f }, size { 8.f, 40.f };
+				queue.push_scissor( position, size );
+				queue.push_filled_rectangle( { 0.f, 20.f }, { 64.f, 8.f }, daisy::color_t( 0, 255, 0 ) );
+			} );
+		printf( "%s: scissored rect\n", path );
+		check_rect( cpu, "scissored rect", 16, 20, 24, 28, bgra( 0, 255, 0 ), bgra( 0, 0, 0 ) );
+	}
+
+	// a later drawcall covers an earlier one
+	render( cpu, false, [ ]( daisy::c_renderqueue& queue )
+		{
+			queue.push_filled_rectangle( { 0.f, 0.f }, { 32.f, 32.f }, daisy::color_t( 0, 0, 255 ) );
+			queue.push_filled_rectangle( { 16.f, 16.f }, { 32.f, 32.f }, daisy::color_t( 255, 255, 0 ) );
+		} );
+	printf( "draw order\n" );
+	check( pixel( cpu, 8, 8 ) == bgra( 0, 0, 255 ), "draw order first", 8, 8, pixel( cpu, 8, 8 ) );
+	check( pixel( cpu, 20, 20 ) == bgra( 255, 255, 0 ), "draw order second", 20, 20, pixel( cpu, 20, 20 ) );
+	check( pixel( cpu, 60, 60 ) == bgra( 0, 0, 0 ), "draw order background", 60, 60, pixel( cpu, 60, 60 ) );
+
+	printf( g_failures ? "%u check(s) failed\n" : "all checks passed\n", g_failures );
+	return static_cast< int >( g_failures );
+}